@@ -8,4 +8,28 @@ namespace ps {
 Ai::Ai(Piece::Color playerColor) :
 		Player(playerColor) {}
 
+void Ai::SetOpeningBook(const OpeningBook *book) {
+	_opening_book = book;
+}
+
+void Ai::SetTablebase(const Tablebase *tablebase) {
+	_tablebase = tablebase;
+}
+
+bool Ai::_ProbeBook(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::mt19937_64& rng, Move& move) const {
+	if (!_opening_book || !_opening_book->IsOpen()) {
+		return false;
+	}
+
+	return _opening_book->Probe(board, _player_color, moveData, possible, rng, move);
+}
+
+bool Ai::_ProbeTablebase(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, Move& move) const {
+	if (!_tablebase) {
+		return false;
+	}
+
+	return _tablebase->ProbeMove(board, _player_color, moveData, possible, move);
+}
+
 }
@@ -5,14 +5,46 @@
 #define AI_H_
 
 #include "Player.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
+
+#include <random>
 
 namespace ps {
 
 class Ai : public Player {
 
+public:
+	/**
+	 * Sets the opening book to play from, or nullptr to not use a book. The
+	 * book is shared and not owned by the player.
+	 */
+	void SetOpeningBook(const OpeningBook *book);
+
+	/**
+	 * Sets the endgame tables to play from, or nullptr to not use tables. The
+	 * tables are shared and not owned by the player.
+	 */
+	void SetTablebase(const Tablebase *tablebase);
+
 protected:
 	Ai(Piece::Color playerColor);
 
+	/**
+	 * Looks up the position in the opening book. Returns false if there is no
+	 * book or no possible book move.
+	 */
+	bool _ProbeBook(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::mt19937_64& rng, Move& move) const;
+
+	/**
+	 * Looks up the best move in the endgame tables. Returns false if there are
+	 * no tables for the position.
+	 */
+	bool _ProbeTablebase(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, Move& move) const;
+
+	const OpeningBook *_opening_book = nullptr;
+	const Tablebase *_tablebase = nullptr;
+
 };
 
 }
@@ -0,0 +1,490 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "AiMcts.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ps {
+
+MctsNodePool::MctsNodePool(size_t capacity) :
+		_nodes(new MctsNode[capacity]), _capacity(capacity) {}
+
+MctsNode *MctsNodePool::Allocate(size_t count, size_t limit) {
+	limit = std::min(limit, _capacity);
+	size_t start = _size.load();
+
+	do {
+		if (start + count > limit) {
+			return nullptr;
+		}
+	} while (!_size.compare_exchange_weak(start, start + count));
+
+	for (size_t i = start; i < start + count; i++) {
+		MctsNode& node = _nodes[i];
+		node.parent = nullptr;
+		node.children = nullptr;
+		node.child_count = 0;
+		node.state.store(MctsNode::State::UNEXPANDED, std::memory_order_relaxed);
+		node.visits.store(0, std::memory_order_relaxed);
+		node.value.store(0, std::memory_order_relaxed);
+		node.terminal_value = 0;
+	}
+
+	return &_nodes[start];
+}
+
+void MctsNodePool::Clear() {
+	_size.store(0);
+}
+
+size_t MctsNodePool::GetSize() const {
+	return _size.load();
+}
+
+size_t MctsNodePool::GetCapacity() const {
+	return _capacity;
+}
+
+AiMcts::AiMcts(Piece::Color playerColor, std::chrono::milliseconds moveTime, size_t maxPlayouts, size_t threadCount) :
+		Ai(playerColor), _move_time(moveTime), _max_playouts(maxPlayouts),
+		_thread_pool(threadCount > 0 ? std::make_unique<ThreadPool>(threadCount) : nullptr), _pool(_POOL_CAPACITY),
+		_rng(std::random_device()()) {}
+
+AiMcts::~AiMcts() {
+	StopPondering();
+}
+
+Move AiMcts::MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) {
+	if (possible.size() == 1) {
+		return possible.front();
+	}
+
+	if (Move bookMove; _ProbeBook(board, moveData, possible, _rng, bookMove)) {
+		return bookMove;
+	}
+
+	if (Move tablebaseMove; _ProbeTablebase(board, moveData, possible, tablebaseMove)) {
+		return tablebaseMove;
+	}
+
+	// reuse the tree of our previous move or of the ponder search. The
+	// position is either the root itself or two plies below it.
+	_SetRoot(board, moveData, _player_color, 2);
+
+	if (_root->state.load() == MctsNode::State::UNEXPANDED) {
+		MctsNode *children = _pool.Allocate(possible.size());
+
+		// a reused tree can leave too little room for the moves of the root,
+		// in which case the search starts over from an empty pool.
+		if (!children) {
+			_pool.Clear();
+			_root = _pool.Allocate(1);
+			children = _pool.Allocate(possible.size());
+		}
+
+		for (size_t i = 0; i < possible.size(); i++) {
+			children[i].move = possible[i];
+			children[i].parent = _root;
+		}
+
+		_root->children = children;
+		_root->child_count = uint32_t(possible.size());
+		_root->state.store(MctsNode::State::EXPANDED);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	size_t startNodes = _pool.GetSize();
+	uint64_t reusedVisits = _root->visits;
+
+	if (_clock) {
+		_time_manager.Start(*_clock, _player_color, possible.size());
+	} else {
+		_time_manager.Start(_move_time);
+	}
+
+	// search until the time or the playouts run out
+	_node_limit = SIZE_MAX;
+	_StartSearch(stop, _time_manager.GetHardDeadline(), true);
+	_WaitSearch();
+
+	const MctsNode *best = _BestChild(_root);
+
+	_ReportStatistics(best, start, startNodes, reusedVisits);
+	return best->move;
+}
+
+void AiMcts::StartPondering(const Board& board, const GameMoveData& moveData) {
+	if (!_thread_pool) {
+		return;
+	}
+
+	// the opponent's position is one ply below the root of our last search.
+	_SetRoot(board, moveData, opposite(_player_color), 1);
+
+	_ponder_stop.store(false);
+	_node_limit = _REUSE_CAPACITY;
+	_StartSearch(_ponder_stop, std::chrono::steady_clock::time_point::max(), false);
+}
+
+void AiMcts::StopPondering() {
+	_ponder_stop.store(true);
+	_WaitSearch();
+}
+
+void AiMcts::SetMoveTime(std::chrono::milliseconds moveTime) {
+	_move_time = moveTime;
+}
+
+void AiMcts::SetMaxPlayouts(size_t maxPlayouts) {
+	_max_playouts = maxPlayouts;
+}
+
+std::vector<MctsRootMove> AiMcts::GetRootMoves() const {
+	std::vector<MctsRootMove> moves;
+
+	if (!_root || _root->state.load() != MctsNode::State::EXPANDED) {
+		return moves;
+	}
+
+	for (uint32_t i = 0; i < _root->child_count; i++) {
+		const MctsNode *child = &_root->children[i];
+		moves.push_back({ child->move, child->visits.load(), _ValueToScore(child) });
+	}
+
+	std::stable_sort(moves.begin(), moves.end(), [](const auto& a, const auto& b) {
+		return a.visits > b.visits;
+	});
+
+	return moves;
+}
+
+void AiMcts::_SetRoot(const Board& board, const GameMoveData& moveData, Piece::Color playerColor, int searchDepth) {
+	Game target;
+	target.SetState(board, moveData, playerColor);
+
+	// a larger tree is discarded, to leave room for the next search.
+	MctsNode *found = nullptr;
+	if (_root && _pool.GetSize() <= _REUSE_CAPACITY) {
+		found = _Find(_root, _root_state, target, searchDepth);
+	}
+
+	// a node that was scored as a repetition or by the endgame tables has no
+	// subtree, but a root must have its moves.
+	if (found && found->state.load() == MctsNode::State::TERMINAL) {
+		found = nullptr;
+	}
+
+	if (found) {
+		_root = found;
+		_root->parent = nullptr;
+	} else {
+		_pool.Clear();
+		_root = _pool.Allocate(1);
+	}
+
+	_root_state = target;
+	_root_evaluator.Reset(_root_state.GetBoard());
+
+	// continue the history of the game, so repetitions of its positions are
+	// found in the search.
+	if (_position_history && !_position_history->IsEmpty() &&
+			_position_history->GetLast() == _root_state.GetHistory().GetLast()) {
+
+		_root_state.SetHistory(*_position_history);
+	}
+}
+
+MctsNode *AiMcts::_Find(MctsNode *node, const Game& state, const Game& target, int depth) const {
+	if (state.GetPlayerColor() == target.GetPlayerColor() &&
+			state.GetBoard() == target.GetBoard() &&
+			state.GetMoveData() == target.GetMoveData()) {
+		return node;
+	}
+
+	if (depth == 0 || node->state.load() != MctsNode::State::EXPANDED) {
+		return nullptr;
+	}
+
+	for (uint32_t i = 0; i < node->child_count; i++) {
+		Game next = state;
+		next.MakeMove(node->children[i].move);
+
+		if (MctsNode *found = _Find(&node->children[i], next, target, depth - 1)) {
+			return found;
+		}
+	}
+
+	return nullptr;
+}
+
+void AiMcts::_StartSearch(std::atomic_bool& stop, std::chrono::steady_clock::time_point deadline, bool manageTime) {
+	_playouts.store(0);
+	_done.store(false);
+	_deadline = deadline;
+
+	_selective_depth.store(0);
+	_collisions.store(0);
+	_chain_generation_time.store(0);
+	_legality_time.store(0);
+
+	// without threads of our own, this is a search for a move on the calling
+	// thread, which is done when this returns.
+	if (!_thread_pool) {
+		_Search(_rng(), stop, manageTime);
+		return;
+	}
+
+	for (size_t i = 0; i < _thread_pool->GetThreadCount(); i++) {
+		// the first worker checks the soft limit of the time manager
+		_workers.push_back(_thread_pool->Submit([this, &stop, seed = _rng(), manageTime = manageTime && i == 0]() {
+			_Search(seed, stop, manageTime);
+		}));
+	}
+}
+
+void AiMcts::_WaitSearch() {
+	for (auto& worker : _workers) {
+		worker.wait();
+	}
+
+	_workers.clear();
+}
+
+void AiMcts::_ReportStatistics(const MctsNode *best, std::chrono::steady_clock::time_point start, size_t startNodes, uint64_t reusedVisits) const {
+	if (!_statistics_sink) {
+		return;
+	}
+
+	SearchStatistics statistics;
+	statistics.player = _player_color;
+	statistics.best_move = best->move;
+	statistics.score = _ValueToScore(best);
+	statistics.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	statistics.nodes = _pool.GetSize() - startNodes;
+	statistics.playouts = _playouts;
+	statistics.selective_depth = _selective_depth;
+	statistics.reused_visits = reusedVisits;
+	statistics.collisions = _collisions;
+	statistics.chain_generation_time = std::chrono::nanoseconds(_chain_generation_time);
+	statistics.legality_time = std::chrono::nanoseconds(_legality_time);
+
+	// follow the most visited moves for the principal variation
+	for (const MctsNode *node = _root; node->state.load() == MctsNode::State::EXPANDED; statistics.depth++) {
+		node = _BestChild(node);
+	}
+
+	_statistics_sink->ReportSearch(statistics);
+}
+
+void AiMcts::_Search(uint64_t seed, std::atomic_bool& stop, bool manageTime) {
+	std::mt19937_64 rng(seed);
+	MoveGenerationProfile profile = Board::GetMoveGenerationProfile();
+
+	const MctsNode *best = nullptr;
+	size_t playouts = 0;
+
+	while (!_done && !stop) {
+		if (std::chrono::steady_clock::now() >= _deadline ||
+				(_max_playouts != 0 && _playouts >= _max_playouts)) {
+			_done.store(true);
+			break;
+		}
+
+		_Playout(rng);
+		_playouts++;
+
+		if (manageTime && ++playouts % _STABILITY_INTERVAL == 0) {
+			const MctsNode *currentBest = _BestChild(_root);
+			_time_manager.Update(currentBest != best);
+			best = currentBest;
+
+			if (_time_manager.IsSoftLimitReached()) {
+				_done.store(true);
+			}
+		}
+	}
+
+	const MoveGenerationProfile& end = Board::GetMoveGenerationProfile();
+	_chain_generation_time += (end.chain_generation - profile.chain_generation).count();
+	_legality_time += (end.legality - profile.legality).count();
+}
+
+void AiMcts::_Playout(std::mt19937_64& rng) {
+	Game state = _root_state;
+	Evaluator evaluator = _root_evaluator;
+	MctsNode *node = _root;
+	node->visits++;
+	int depth = 0;
+
+	// selection
+	while (node->state.load(std::memory_order_acquire) == MctsNode::State::EXPANDED) {
+		node = _Select(node);
+		node->visits++;
+		evaluator.Update(state.GetBoard(), state.MakeMove(node->move));
+		depth++;
+	}
+
+	// expansion, unless another thread is already expanding this node
+	auto expected = MctsNode::State::UNEXPANDED;
+	if (node->state.compare_exchange_strong(expected, MctsNode::State::EXPANDING)) {
+		_Expand(node, state);
+	} else if (expected == MctsNode::State::EXPANDING) {
+		_collisions++;
+	}
+
+	// simulation
+	int64_t value;
+	if (node->state.load(std::memory_order_acquire) == MctsNode::State::TERMINAL) {
+		value = node->terminal_value;
+	} else {
+		value = _Rollout(state, evaluator, rng, depth);
+	}
+
+	int selectiveDepth = _selective_depth;
+	while (depth > selectiveDepth && !_selective_depth.compare_exchange_weak(selectiveDepth, depth)) {}
+
+	// backpropagation, alternating the perspective at every ply
+	for (MctsNode *n = node; n; n = n->parent) {
+		n->value += value;
+		value = MctsNode::VALUE_SCALE - value;
+	}
+}
+
+const MctsNode *AiMcts::_BestChild(const MctsNode *node) const {
+	// the most visited move is the most robust choice
+	const MctsNode *best = &node->children[0];
+
+	for (uint32_t i = 1; i < node->child_count; i++) {
+		if (node->children[i].visits > best->visits) {
+			best = &node->children[i];
+		}
+	}
+
+	return best;
+}
+
+MctsNode *AiMcts::_Select(MctsNode *node) const {
+	double logVisits = std::log(double(std::max(node->visits.load(), 1u)));
+
+	MctsNode *best = nullptr;
+	double bestScore = -1.0;
+
+	for (uint32_t i = 0; i < node->child_count; i++) {
+		MctsNode *child = &node->children[i];
+		uint32_t visits = child->visits;
+
+		if (visits == 0) {
+			return child;
+		}
+
+		double exploitation = double(child->value) / double(MctsNode::VALUE_SCALE * visits);
+		double exploration = _EXPLORATION * std::sqrt(logVisits / visits);
+		double score = exploitation + exploration;
+
+		if (score > bestScore) {
+			best = child;
+			bestScore = score;
+		}
+	}
+
+	return best;
+}
+
+bool AiMcts::_Expand(MctsNode *node, const Game& state) {
+	// a repeated position is scored as a draw, since whoever repeated it can
+	// keep repeating it. Every node is reached by a single path, so the score
+	// holds for all playouts through it.
+	if (node != _root && state.IsRepetition(2)) {
+		node->terminal_value = MctsNode::VALUE_SCALE / 2;
+		node->state.store(MctsNode::State::TERMINAL, std::memory_order_release);
+		return true;
+	}
+
+	// positions in the endgame tables are scored exactly, without a subtree.
+	if (TablebaseResult result; node != _root && _tablebase &&
+			_tablebase->Probe(state.GetBoard(), state.GetPlayerColor(), state.GetMoveData(), result)) {
+		node->terminal_value = _TablebaseValue(result);
+		node->state.store(MctsNode::State::TERMINAL, std::memory_order_release);
+		return true;
+	}
+
+	auto moves = state.GetBoard().GetAllPossibleMoves(state.GetPlayerColor(), state.GetMoveData());
+
+	if (moves.empty()) {
+		node->terminal_value = _TerminalValue(state);
+		node->state.store(MctsNode::State::TERMINAL, std::memory_order_release);
+		return true;
+	}
+
+	MctsNode *children = _pool.Allocate(moves.size(), _node_limit);
+
+	if (!children) {
+		// the tree is full, or as large as a ponder tree may grow; finish the
+		// search with what we have.
+		node->state.store(MctsNode::State::UNEXPANDED, std::memory_order_release);
+		_done.store(true);
+		return false;
+	}
+
+	for (size_t i = 0; i < moves.size(); i++) {
+		children[i].move = std::move(moves[i]);
+		children[i].parent = node;
+	}
+
+	node->children = children;
+	node->child_count = uint32_t(moves.size());
+	node->state.store(MctsNode::State::EXPANDED, std::memory_order_release);
+	return true;
+}
+
+int64_t AiMcts::_Rollout(Game& state, Evaluator& evaluator, std::mt19937_64& rng, int& depth) const {
+	Piece::Color mover = opposite(state.GetPlayerColor());
+
+	for (int i = 0; i < _ROLLOUT_DEPTH; i++, depth++) {
+		auto moves = state.GetBoard().GetAllPossibleMoves(state.GetPlayerColor(), state.GetMoveData());
+
+		if (moves.empty()) {
+			int64_t value = _TerminalValue(state);
+			return opposite(state.GetPlayerColor()) == mover ? value : MctsNode::VALUE_SCALE - value;
+		}
+
+		std::uniform_int_distribution<size_t> dist(0, moves.size() - 1);
+		evaluator.Update(state.GetBoard(), state.MakeMove(moves[dist(rng)]));
+	}
+
+	// score the final position as a win probability
+	int score = evaluator.Evaluate(mover);
+	return int64_t(MctsNode::VALUE_SCALE / (1.0 + std::exp(-score / _EVALUATION_SCALE)));
+}
+
+int64_t AiMcts::_TerminalValue(const Game& state) const {
+	// the player to move has no moves: the previous player either mated them
+	// or stalemated them.
+	if (state.GetBoard().IsSako(state.GetPlayerColor(), state.GetMoveData())) {
+		return MctsNode::VALUE_SCALE;
+	}
+
+	return MctsNode::VALUE_SCALE / 2;
+}
+
+int AiMcts::_ValueToScore(const MctsNode *node) const {
+	// the inverse of the sigmoid that maps rollout evaluations to values
+	uint32_t visits = std::max(node->visits.load(), 1u);
+	double probability = double(node->value.load()) / (double(visits) * MctsNode::VALUE_SCALE);
+	probability = std::min(std::max(probability, 0.001), 0.999);
+
+	return int(-_EVALUATION_SCALE * std::log(1.0 / probability - 1.0));
+}
+
+int64_t AiMcts::_TablebaseValue(const TablebaseResult& result) const {
+	// the result is for the player to move, the value for the previous player.
+	switch (result.outcome) {
+		case TablebaseResult::Outcome::LOSS: return MctsNode::VALUE_SCALE;
+		case TablebaseResult::Outcome::WIN: return 0;
+		default: return MctsNode::VALUE_SCALE / 2;
+	}
+}
+
+}
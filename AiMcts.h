@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef AIMCTS_H_
+#define AIMCTS_H_
+
+#include "Ai.h"
+#include "Evaluator.h"
+#include "Game.h"
+#include "ThreadPool.h"
+#include "TimeManager.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+namespace ps {
+
+class MctsNode {
+
+public:
+	enum class State : uint8_t {
+		UNEXPANDED, EXPANDING, EXPANDED, TERMINAL
+	};
+
+public:
+	// the move that led to this node.
+	Move move;
+	MctsNode *parent = nullptr;
+
+	// the children are allocated contiguously from the node pool.
+	MctsNode *children = nullptr;
+	uint32_t child_count = 0;
+
+	std::atomic<State> state { State::UNEXPANDED };
+
+	// visits are counted on the way down, so a playout in progress acts as a
+	// virtual loss for the other threads until its value is backed up.
+	std::atomic<uint32_t> visits { 0 };
+
+	// the summed results from the perspective of the player that made the
+	// move into this node, in units of 1 / VALUE_SCALE.
+	std::atomic<int64_t> value { 0 };
+
+	// the result of a terminal node, in units of 1 / VALUE_SCALE.
+	int64_t terminal_value = 0;
+
+public:
+	static constexpr int64_t VALUE_SCALE = 1000;
+
+};
+
+/**
+ * A fixed-size arena of nodes. Allocation is a single atomic increment, and
+ * all nodes are released at once when the search tree is discarded.
+ */
+class MctsNodePool {
+
+public:
+	MctsNodePool(size_t capacity);
+
+	/**
+	 * Returns count contiguous nodes, or nullptr if that would take the pool
+	 * beyond limit nodes or its capacity.
+	 */
+	MctsNode *Allocate(size_t count, size_t limit = SIZE_MAX);
+
+	void Clear();
+
+	size_t GetSize() const;
+	size_t GetCapacity() const;
+
+private:
+	std::unique_ptr<MctsNode[]> _nodes;
+	size_t _capacity;
+	std::atomic<size_t> _size { 0 };
+
+};
+
+/**
+ * A move of the root of a search, with its number of visits and its score in
+ * centipawns from the perspective of the player.
+ */
+struct MctsRootMove {
+	Move move;
+	uint32_t visits;
+	int score;
+};
+
+/**
+ * A Monte Carlo tree search player. Playouts are distributed over a thread
+ * pool, and each playout descends the tree by UCT, expands a leaf with all
+ * legal moves, and finishes with a short random rollout that is scored by
+ * the static evaluation.
+ *
+ * The search tree is kept between moves. While the opponent is thinking, the
+ * player ponders on the opponent's position, and when the opponent's move is
+ * found in the tree, its subtree becomes the root of the next search.
+ */
+class AiMcts : public Ai {
+
+public:
+	/**
+	 * The search is bounded by the move time, and by the number of playouts if
+	 * maxPlayouts is not zero. When the game is played with a clock, the time
+	 * manager budgets the time instead of the fixed move time.
+	 *
+	 * With a thread count of zero, the player has no threads of its own: it
+	 * searches on the thread that calls MakeMove() and does not ponder, which
+	 * suits games that share a set of threads.
+	 */
+	AiMcts(Piece::Color playerColor,
+			std::chrono::milliseconds moveTime = std::chrono::milliseconds(1000),
+			size_t maxPlayouts = 0,
+			size_t threadCount = std::thread::hardware_concurrency());
+	~AiMcts();
+
+	Move MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) override;
+
+	void StartPondering(const Board& board, const GameMoveData& moveData) override;
+	void StopPondering() override;
+
+	/**
+	 * Changes the limits of the next searches, see the constructor.
+	 */
+	void SetMoveTime(std::chrono::milliseconds moveTime);
+	void SetMaxPlayouts(size_t maxPlayouts);
+
+	/**
+	 * Returns the moves of the root of the last search, most visited first.
+	 * Only valid after MakeMove() searched, until the next search or ponder.
+	 */
+	std::vector<MctsRootMove> GetRootMoves() const;
+
+private:
+	void _SetRoot(const Board& board, const GameMoveData& moveData, Piece::Color playerColor, int searchDepth);
+	MctsNode *_Find(MctsNode *node, const Game& state, const Game& target, int depth) const;
+	void _StartSearch(std::atomic_bool& stop, std::chrono::steady_clock::time_point deadline, bool manageTime);
+	void _WaitSearch();
+
+	void _Search(uint64_t seed, std::atomic_bool& stop, bool manageTime);
+	const MctsNode *_BestChild(const MctsNode *node) const;
+	void _Playout(std::mt19937_64& rng);
+	void _ReportStatistics(const MctsNode *best, std::chrono::steady_clock::time_point start, size_t startNodes, uint64_t reusedVisits) const;
+	MctsNode *_Select(MctsNode *node) const;
+	bool _Expand(MctsNode *node, const Game& state);
+	int64_t _Rollout(Game& state, Evaluator& evaluator, std::mt19937_64& rng, int& depth) const;
+	int64_t _TerminalValue(const Game& state) const;
+	int64_t _TablebaseValue(const TablebaseResult& result) const;
+	int _ValueToScore(const MctsNode *node) const;
+
+	std::chrono::milliseconds _move_time;
+	size_t _max_playouts;
+
+	std::unique_ptr<ThreadPool> _thread_pool;
+	MctsNodePool _pool;
+
+	std::mt19937_64 _rng;
+
+	Game _root_state;
+	MctsNode *_root = nullptr;
+
+	// the evaluation of the root position, which every playout copies and
+	// updates with the moves it makes.
+	Evaluator _root_evaluator;
+
+	TimeManager _time_manager;
+	std::vector<std::future<void>> _workers;
+	std::chrono::steady_clock::time_point _deadline;
+	size_t _node_limit = SIZE_MAX;
+	std::atomic<size_t> _playouts { 0 };
+	std::atomic_bool _done { false };
+	std::atomic_bool _ponder_stop { false };
+
+	// statistics of the current search
+	std::atomic<int> _selective_depth { 0 };
+	std::atomic<uint64_t> _collisions { 0 };
+	std::atomic<int64_t> _chain_generation_time { 0 };
+	std::atomic<int64_t> _legality_time { 0 };
+
+private:
+	static constexpr size_t _POOL_CAPACITY = 1 << 18;
+
+	// the largest tree that is kept for the next search. Pondering stops
+	// when its tree reaches this size, so a ponder hit always reuses it.
+	static constexpr size_t _REUSE_CAPACITY = _POOL_CAPACITY / 2;
+	static constexpr int _ROLLOUT_DEPTH = 4;
+	static constexpr size_t _STABILITY_INTERVAL = 32;
+	static constexpr double _EXPLORATION = 1.41;
+	static constexpr double _EVALUATION_SCALE = 400.0;
+
+};
+
+}
+
+#endif
@@ -9,8 +9,8 @@
 
 namespace ps {
 
-AiRandom::AiRandom(Piece::Color playerColor) :
-	 Ai(playerColor) {
+AiRandom::AiRandom(Piece::Color playerColor, std::chrono::milliseconds delay) :
+	 Ai(playerColor), _delay(delay) {
 
 	auto seed = time(nullptr) * std::intptr_t(this);
 	std::cout << (playerColor == Piece::Color::WHITE ? "white" : "black") << " seed: " << seed << std::endl;
@@ -18,7 +18,9 @@ AiRandom::AiRandom(Piece::Color playerColor) :
 }
 
 Move AiRandom::MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) {
-	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	if (_delay.count() > 0) {
+		std::this_thread::sleep_for(_delay);
+	}
 
 	std::uniform_int_distribution<size_t> dist(0, possible.size() - 1);
 	size_t index = dist(_rng);
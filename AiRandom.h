@@ -6,6 +6,7 @@
 
 #include "Ai.h"
 
+#include <chrono>
 #include <random>
 
 namespace ps {
@@ -13,11 +14,16 @@ namespace ps {
 class AiRandom : public Ai {
 
 public:
-	AiRandom(Piece::Color playerColor);
+	/**
+	 * The player waits for the delay before every move, so that its games can
+	 * be followed on screen. Headless games can use a delay of zero.
+	 */
+	AiRandom(Piece::Color playerColor, std::chrono::milliseconds delay = std::chrono::milliseconds(100));
 
 	Move MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) override;
 
 private:
+	std::chrono::milliseconds _delay;
 	std::mt19937_64 _rng;
 
 };
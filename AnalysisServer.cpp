@@ -0,0 +1,357 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "AnalysisServer.h"
+
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+namespace ps {
+
+/**
+ * Reads the six fields of a PsFEN from the stream.
+ */
+static bool readPsFEN(std::istringstream& in, Game& game) {
+	std::string psFEN, field;
+
+	for (int i = 0; i < 6; i++) {
+		if (!(in >> field)) {
+			return false;
+		}
+
+		psFEN += (i > 0 ? " " : "") + field;
+	}
+
+	return game.SetState(psFEN);
+}
+
+AnalysisServer::AnalysisServer(const AnalysisServerSettings& settings) :
+		_settings(settings),
+		_thread_pool(std::max<size_t>(settings.threads, 1)) {}
+
+AnalysisServer::~AnalysisServer() {
+	Stop();
+
+	for (auto& thread : _connection_threads) {
+		thread.join();
+	}
+
+	if (_dispatcher.joinable()) {
+		_dispatcher.join();
+	}
+}
+
+bool AnalysisServer::ListenTcp(uint16_t port) {
+	return _listener.ListenTcp(port);
+}
+
+bool AnalysisServer::ListenUnix(const std::string& path) {
+	return _listener.ListenUnix(path);
+}
+
+void AnalysisServer::Run() {
+	if (!_dispatcher.joinable()) {
+		_dispatcher = std::thread(&AnalysisServer::_DispatcherMain, this);
+	}
+
+	while (!_stop) {
+		Socket socket = _listener.Accept();
+
+		if (!socket.IsOpen()) {
+			continue;
+		}
+
+		auto connection = std::make_shared<_Connection>();
+		connection->socket = std::move(socket);
+
+		std::lock_guard<std::mutex> lock(_connections_mutex);
+		if (_stop) {
+			break;
+		}
+
+		_JoinFinishedConnections();
+		_connections.push_back(connection);
+		_connection_threads.emplace_back(&AnalysisServer::_ConnectionMain, this, connection);
+	}
+}
+
+void AnalysisServer::Stop() {
+	_stop.store(true);
+	_listener.Shutdown();
+
+	{
+		std::lock_guard<std::mutex> lock(_connections_mutex);
+		for (auto& connection : _connections) {
+			connection->socket.Shutdown();
+		}
+	}
+
+	// the lock orders the notification after a dispatcher that is about to
+	// wait has checked the stop flag.
+	std::lock_guard<std::mutex> lock(_queue_mutex);
+	_queue_condition.notify_all();
+}
+
+std::string AnalysisServer::Execute(const std::string& request) {
+	std::istringstream in(request);
+	std::string command;
+	in >> command;
+
+	Game game;
+
+	if (command != "moves" && command != "apply" && command != "analyse") {
+		return "error unknown request " + command;
+	}
+
+	if (!readPsFEN(in, game)) {
+		return "error invalid psfen";
+	}
+
+	if (command == "moves") {
+		return _Moves(game);
+	}
+
+	if (command == "apply") {
+		std::string move;
+		in >> move;
+		return _Apply(game, move);
+	}
+
+	std::chrono::milliseconds moveTime = _settings.move_time;
+	size_t playouts = 0;
+
+	for (std::string token; in >> token;) {
+		int64_t value;
+		if (!(in >> value)) {
+			break;
+		}
+
+		if (token == "movetime") {
+			moveTime = std::chrono::milliseconds(value);
+		} else if (token == "playouts") {
+			playouts = size_t(value);
+		}
+	}
+
+	return _Analyse(game, moveTime, playouts);
+}
+
+void AnalysisServer::_ConnectionMain(std::shared_ptr<_Connection> connection) {
+	uint64_t sequence = 0;
+
+	for (std::string line; !_stop && connection->socket.ReadLine(line);) {
+		if (line == "quit") {
+			break;
+		}
+
+		if (line.empty()) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(_queue_mutex);
+		_queue.push_back({ connection, sequence++, std::move(line) });
+		_queue_condition.notify_one();
+	}
+
+	connection->socket.Shutdown();
+	connection->finished.store(true);
+}
+
+void AnalysisServer::_JoinFinishedConnections() {
+	for (size_t i = 0; i < _connections.size();) {
+		if (!_connections[i]->finished) {
+			i++;
+			continue;
+		}
+
+		_connection_threads[i].join();
+		_connection_threads.erase(_connection_threads.begin() + i);
+		_connections.erase(_connections.begin() + i);
+	}
+}
+
+void AnalysisServer::_DispatcherMain() {
+	while (true) {
+		std::vector<_Request> batch;
+
+		{
+			std::unique_lock<std::mutex> lock(_queue_mutex);
+			_queue_condition.wait(lock, [this]() {
+				return !_queue.empty() || _stop;
+			});
+
+			if (_stop) {
+				return;
+			}
+
+			size_t count = std::min(_queue.size(), _settings.batch_size);
+			batch.assign(std::make_move_iterator(_queue.begin()), std::make_move_iterator(_queue.begin() + count));
+			_queue.erase(_queue.begin(), _queue.begin() + count);
+		}
+
+		// identical requests are computed once
+		std::unordered_map<std::string, std::vector<_Request>> groups;
+		for (_Request& request : batch) {
+			groups[request.line].push_back(std::move(request));
+		}
+
+		auto cheap = std::make_shared<std::vector<std::vector<_Request>>>();
+
+		for (auto& group : groups) {
+			if (!_IsAnalysis(group.first)) {
+				cheap->push_back(std::move(group.second));
+				continue;
+			}
+
+			auto requests = std::make_shared<std::vector<_Request>>(std::move(group.second));
+			_thread_pool.Submit([this, requests]() {
+				std::string response = Execute(requests->front().line);
+
+				for (const _Request& request : *requests) {
+					_Respond(*request.connection, request.sequence, response);
+				}
+			});
+		}
+
+		if (!cheap->empty()) {
+			_thread_pool.Submit([this, cheap]() {
+				for (const auto& requests : *cheap) {
+					std::string response = Execute(requests.front().line);
+
+					for (const _Request& request : requests) {
+						_Respond(*request.connection, request.sequence, response);
+					}
+				}
+			});
+		}
+	}
+}
+
+void AnalysisServer::_Respond(_Connection& connection, uint64_t sequence, const std::string& response) {
+	std::lock_guard<std::mutex> lock(connection.mutex);
+	connection.pending.emplace(sequence, response + "\n");
+
+	// responses are written in the order of the requests
+	std::string data;
+	for (auto it = connection.pending.begin(); it != connection.pending.end() && it->first == connection.next_response;
+			it = connection.pending.erase(it)) {
+		data += it->second;
+		connection.next_response++;
+	}
+
+	if (!data.empty()) {
+		connection.socket.Write(data);
+	}
+}
+
+std::string AnalysisServer::_Moves(const Game& game) {
+	std::string response = "moves";
+
+	for (const Move& move : *_GetMoves(game)) {
+		response += ' ';
+		response += move.GetName();
+	}
+
+	return response;
+}
+
+std::string AnalysisServer::_Apply(const Game& game, const std::string& name) {
+	auto moves = _GetMoves(game);
+	auto found = std::find_if(moves->begin(), moves->end(), [&name](const Move& move) {
+		return move.GetName() == name;
+	});
+
+	if (found == moves->end()) {
+		return "error illegal move " + name;
+	}
+
+	Game next = game;
+	next.MakeMove(*found);
+	return "psfen " + next.GetPsFEN();
+}
+
+std::string AnalysisServer::_Analyse(const Game& game, std::chrono::milliseconds moveTime, size_t playouts) {
+	auto moves = _GetMoves(game);
+	if (moves->empty()) {
+		return "error no legal moves";
+	}
+
+	std::unique_ptr<AiMcts> player = _AcquirePlayer(game.GetPlayerColor());
+	LastSearchStatisticsSink sink;
+
+	player->SetStatisticsSink(&sink);
+	player->SetMoveTime(playouts > 0 ? std::chrono::hours(24) : moveTime);
+	player->SetMaxPlayouts(playouts);
+
+	Move best = player->MakeMove(game.GetBoard(), game.GetMoveData(), *moves, _stop);
+
+	player->SetStatisticsSink(nullptr);
+	_ReleasePlayer(game.GetPlayerColor(), std::move(player));
+
+	const SearchStatistics& statistics = sink.GetLast();
+
+	std::ostringstream ss;
+	ss << "bestmove " << best.GetName()
+			<< " score " << statistics.score
+			<< " depth " << statistics.depth
+			<< " playouts " << statistics.playouts;
+
+	return ss.str();
+}
+
+std::shared_ptr<const std::vector<Move>> AnalysisServer::_GetMoves(const Game& game) {
+	uint64_t hash = Zobrist::Hash(game.GetBoard(), game.GetPlayerColor(), game.GetMoveData());
+	_CacheShard& shard = _cache[hash % _cache.size()];
+
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto found = shard.moves.find(hash);
+
+		if (found != shard.moves.end()) {
+			return found->second;
+		}
+	}
+
+	auto moves = std::make_shared<const std::vector<Move>>(
+			game.GetBoard().GetAllPossibleMoves(game.GetPlayerColor(), game.GetMoveData()));
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	// a full shard is emptied, which is cheaper than tracking the least
+	// recently used positions.
+	if (shard.moves.size() >= std::max<size_t>(_settings.cache_capacity / _cache.size(), 1)) {
+		shard.moves.clear();
+	}
+
+	shard.moves.emplace(hash, moves);
+	return moves;
+}
+
+std::unique_ptr<AiMcts> AnalysisServer::_AcquirePlayer(Piece::Color color) {
+	std::lock_guard<std::mutex> lock(_players_mutex);
+	auto& idle = _players[color == Piece::Color::BLACK];
+
+	// the players have no threads of their own, and search on the worker of
+	// the analysis task.
+	if (idle.empty()) {
+		return std::make_unique<AiMcts>(color, _settings.move_time, 0, 0);
+	}
+
+	std::unique_ptr<AiMcts> player = std::move(idle.back());
+	idle.pop_back();
+	return player;
+}
+
+void AnalysisServer::_ReleasePlayer(Piece::Color color, std::unique_ptr<AiMcts> player) {
+	std::lock_guard<std::mutex> lock(_players_mutex);
+	_players[color == Piece::Color::BLACK].push_back(std::move(player));
+}
+
+bool AnalysisServer::_IsAnalysis(const std::string& line) {
+	return line.compare(0, 8, "analyse ") == 0;
+}
+
+}
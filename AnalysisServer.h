@@ -0,0 +1,149 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef ANALYSISSERVER_H_
+#define ANALYSISSERVER_H_
+
+#include "AiMcts.h"
+#include "Game.h"
+#include "SearchStatistics.h"
+#include "Socket.h"
+#include "ThreadPool.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ps {
+
+struct AnalysisServerSettings {
+	size_t threads = std::thread::hardware_concurrency();
+
+	// the most requests that are taken from the queue at once.
+	size_t batch_size = 64;
+
+	// the number of positions whose legal moves are cached.
+	size_t cache_capacity = 1 << 16;
+
+	// the search limits of analyse requests without their own limits.
+	std::chrono::milliseconds move_time { 100 };
+};
+
+/**
+ * A long-lived analysis service for local tools. Clients connect over
+ * loopback TCP or a Unix domain socket and send one request per line:
+ *
+ *   moves <PsFEN>                         moves <move>...
+ *   apply <PsFEN> <move>                  psfen <PsFEN>
+ *   analyse <PsFEN> [movetime <ms>] [playouts <n>]
+ *                                         bestmove <move> score <cp> depth <d> playouts <n>
+ *
+ * Errors are answered with "error <message>". A connection may send several
+ * requests without waiting, and the responses come back in request order.
+ *
+ * All connections share one request queue, one thread pool, a cache of legal
+ * moves by position hash, and a set of search players whose node pools stay
+ * allocated between requests. The dispatcher takes the queued requests in
+ * batches, answers identical requests with a single computation, and runs the
+ * cheap move generation requests of a batch together in one task.
+ */
+class AnalysisServer {
+
+public:
+	AnalysisServer(const AnalysisServerSettings& settings = AnalysisServerSettings());
+	~AnalysisServer();
+
+	bool ListenTcp(uint16_t port);
+	bool ListenUnix(const std::string& path);
+
+	/**
+	 * Accepts connections until Stop() is called.
+	 */
+	void Run();
+	void Stop();
+
+	/**
+	 * Executes a single request on the calling thread and returns the
+	 * response.
+	 */
+	std::string Execute(const std::string& request);
+
+private:
+	struct _Connection {
+		Socket socket;
+
+		std::mutex mutex;
+		std::map<uint64_t, std::string> pending;
+		uint64_t next_response = 0;
+
+		// set by the connection thread when the client has disconnected.
+		std::atomic_bool finished { false };
+	};
+
+	struct _Request {
+		std::shared_ptr<_Connection> connection;
+		uint64_t sequence;
+		std::string line;
+	};
+
+	void _ConnectionMain(std::shared_ptr<_Connection> connection);
+	void _JoinFinishedConnections();
+	void _DispatcherMain();
+	void _Respond(_Connection& connection, uint64_t sequence, const std::string& response);
+
+	std::string _Moves(const Game& game);
+	std::string _Apply(const Game& game, const std::string& name);
+	std::string _Analyse(const Game& game, std::chrono::milliseconds moveTime, size_t playouts);
+
+	std::shared_ptr<const std::vector<Move>> _GetMoves(const Game& game);
+
+	std::unique_ptr<AiMcts> _AcquirePlayer(Piece::Color color);
+	void _ReleasePlayer(Piece::Color color, std::unique_ptr<AiMcts> player);
+
+	static bool _IsAnalysis(const std::string& line);
+
+	AnalysisServerSettings _settings;
+
+	Socket _listener;
+	std::atomic_bool _stop { false };
+
+	std::mutex _connections_mutex;
+	std::vector<std::shared_ptr<_Connection>> _connections;
+
+	// the threads of the connections, at the same indices
+	std::vector<std::thread> _connection_threads;
+
+	// the request queue, drained by the dispatcher thread
+	std::mutex _queue_mutex;
+	std::condition_variable _queue_condition;
+	std::vector<_Request> _queue;
+	std::thread _dispatcher;
+
+	// legal moves by position hash, split into shards with their own locks.
+	struct _CacheShard {
+		std::mutex mutex;
+		std::unordered_map<uint64_t, std::shared_ptr<const std::vector<Move>>> moves;
+	};
+
+	std::array<_CacheShard, 16> _cache;
+
+	// idle search players, by color
+	std::mutex _players_mutex;
+	std::array<std::vector<std::unique_ptr<AiMcts>>, 2> _players;
+
+	// declared last, so the workers are joined before the rest is destroyed
+	ThreadPool _thread_pool;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "ArchiveValidator.h"
+
+#include "ThreadPool.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+
+namespace ps {
+
+static double toMilliseconds(std::chrono::nanoseconds time) {
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+size_t ArchiveValidationSummary::GetInvalidCount() const {
+	return invalid_starts + illegal_moves + hash_mismatches;
+}
+
+ArchiveValidator::ArchiveValidator(const ArchiveValidatorSettings& settings) :
+		_settings(settings) {
+
+	_settings.threads = std::max<size_t>(_settings.threads, 1);
+	_settings.batch_size = std::max<size_t>(_settings.batch_size, 1);
+	_settings.batches_per_thread = std::max<size_t>(_settings.batches_per_thread, 1);
+}
+
+ArchiveValidationSummary ArchiveValidator::Validate(const std::string& file, std::ostream& out) {
+	ArchiveValidationSummary summary;
+	auto start = std::chrono::steady_clock::now();
+
+	GameRecordReader reader;
+	if (!reader.Open(file)) {
+		return summary;
+	}
+
+	ThreadPool pool(_settings.threads);
+
+	// the batches in flight, oldest first. The reader waits for the oldest
+	// batch when the queue is full, so the results come out in order and at
+	// most a fixed number of games are in memory.
+	std::deque<std::future<std::vector<GameValidation>>> pending;
+	size_t maxPending = _settings.threads * _settings.batches_per_thread;
+
+	std::vector<GameRecord> batch;
+	size_t firstIndex = 0;
+
+	auto submit = [&]() {
+		pending.push_back(pool.Submit([batch = std::move(batch), firstIndex]() {
+			std::vector<GameValidation> validations;
+			validations.reserve(batch.size());
+
+			for (size_t i = 0; i < batch.size(); i++) {
+				validations.push_back(ValidateGame(batch[i], firstIndex + i));
+			}
+
+			return validations;
+		}));
+
+		batch.clear();
+		firstIndex = reader.GetGameIndex();
+
+		while (pending.size() >= maxPending) {
+			_Add(pending.front().get(), summary, out);
+			pending.pop_front();
+		}
+	};
+
+	GameRecord record;
+
+	while (reader.Read(record)) {
+		batch.push_back(std::move(record));
+
+		if (batch.size() == _settings.batch_size) {
+			submit();
+		}
+	}
+
+	if (!batch.empty()) {
+		submit();
+	}
+
+	while (!pending.empty()) {
+		_Add(pending.front().get(), summary, out);
+		pending.pop_front();
+	}
+
+	summary.complete = reader.IsAtEnd();
+	summary.wall_time = std::chrono::steady_clock::now() - start;
+
+	if (!summary.complete) {
+		out << "game " << reader.GetGameIndex() << ": malformed record, stopped reading" << std::endl;
+	}
+
+	return summary;
+}
+
+GameValidation ArchiveValidator::ValidateGame(const GameRecord& record, size_t gameIndex) {
+	auto start = std::chrono::steady_clock::now();
+
+	GameValidation validation;
+	validation.game_index = gameIndex;
+	validation.expected_hash = record.final_hash;
+
+	Game game;
+	PsFENError error;
+
+	if (!game.SetState(record.start_psfen, &error)) {
+		validation.status = GameValidation::Status::INVALID_START;
+		validation.detail = "invalid start position at " + std::to_string(error.position) + ": " + error.message;
+	} else {
+		for (const Move& move : record.moves) {
+			auto possible = game.GetBoard().GetAllPossibleMoves(game.GetPlayerColor(), game.GetMoveData());
+
+			if (std::find(possible.begin(), possible.end(), move) == possible.end()) {
+				validation.status = GameValidation::Status::ILLEGAL_MOVE;
+				validation.ply = validation.plies;
+				validation.detail = move.GetName();
+				break;
+			}
+
+			game.MakeMove(move);
+			validation.plies++;
+		}
+
+		if (validation.status == GameValidation::Status::VALID) {
+			validation.actual_hash = Zobrist::Hash(game.GetBoard(), game.GetPlayerColor(), game.GetMoveData());
+
+			if (validation.actual_hash != validation.expected_hash) {
+				validation.status = GameValidation::Status::HASH_MISMATCH;
+			}
+		}
+	}
+
+	validation.time = std::chrono::steady_clock::now() - start;
+	return validation;
+}
+
+void ArchiveValidator::Write(const GameValidation& validation, std::ostream& out) {
+	out << "game " << validation.game_index;
+
+	switch (validation.status) {
+		case GameValidation::Status::VALID:
+			out << ": valid, " << validation.plies << " plies";
+			break;
+		case GameValidation::Status::INVALID_START:
+			out << ": " << validation.detail;
+			break;
+		case GameValidation::Status::ILLEGAL_MOVE:
+			out << " ply " << validation.ply << ": illegal move " << validation.detail;
+			break;
+		case GameValidation::Status::HASH_MISMATCH:
+			out << ": final hash " << std::hex << std::setfill('0') << std::setw(16) << validation.actual_hash
+					<< ", expected " << std::setw(16) << validation.expected_hash << std::dec << std::setfill(' ');
+			break;
+	}
+
+	out << " (" << std::fixed << std::setprecision(3) << toMilliseconds(validation.time) << " ms)"
+			<< std::defaultfloat << '\n';
+}
+
+void ArchiveValidator::Write(const ArchiveValidationSummary& summary, std::ostream& out) {
+	double total = toMilliseconds(summary.replay_time);
+
+	out << summary.games << " games, " << summary.plies << " plies, " << summary.GetInvalidCount() << " invalid ("
+			<< summary.invalid_starts << " invalid starts, " << summary.illegal_moves << " illegal moves, "
+			<< summary.hash_mismatches << " hash mismatches)" << (summary.complete ? "" : ", archive incomplete") << '\n';
+
+	out << std::fixed << std::setprecision(3) << "wall time " << toMilliseconds(summary.wall_time) << " ms, replay time " << total << " ms, "
+			<< (summary.games > 0 ? total / double(summary.games) : 0.0) << " ms per game, slowest game "
+			<< summary.slowest_game << " " << toMilliseconds(summary.slowest_time) << " ms"
+			<< std::defaultfloat << std::endl;
+}
+
+void ArchiveValidator::_Add(const std::vector<GameValidation>& validations, ArchiveValidationSummary& summary, std::ostream& out) const {
+	for (const GameValidation& validation : validations) {
+		summary.games++;
+		summary.plies += validation.plies;
+		summary.replay_time += validation.time;
+
+		if (validation.time > summary.slowest_time) {
+			summary.slowest_time = validation.time;
+			summary.slowest_game = validation.game_index;
+		}
+
+		switch (validation.status) {
+			case GameValidation::Status::VALID:
+				break;
+			case GameValidation::Status::INVALID_START:
+				summary.invalid_starts++;
+				break;
+			case GameValidation::Status::ILLEGAL_MOVE:
+				summary.illegal_moves++;
+				break;
+			case GameValidation::Status::HASH_MISMATCH:
+				summary.hash_mismatches++;
+				break;
+		}
+
+		if (_settings.verbose || validation.status != GameValidation::Status::VALID) {
+			Write(validation, out);
+		}
+	}
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef ARCHIVEVALIDATOR_H_
+#define ARCHIVEVALIDATOR_H_
+
+#include "GameRecord.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ps {
+
+struct ArchiveValidatorSettings {
+	size_t threads = std::thread::hardware_concurrency();
+
+	// the number of games replayed by one task, and the number of tasks that
+	// may be in flight per thread. Together they bound the memory use.
+	size_t batch_size = 64;
+	size_t batches_per_thread = 2;
+
+	// report every game with its timing, not only the invalid ones.
+	bool verbose = false;
+};
+
+struct GameValidation {
+	enum class Status {
+		VALID, INVALID_START, ILLEGAL_MOVE, HASH_MISMATCH
+	};
+
+	size_t game_index = 0;
+	Status status = Status::VALID;
+
+	// the ply and the name of the illegal move, or the error in the start
+	// position.
+	size_t ply = 0;
+	std::string detail;
+
+	uint64_t expected_hash = 0;
+	uint64_t actual_hash = 0;
+
+	size_t plies = 0;
+	std::chrono::nanoseconds time { 0 };
+};
+
+struct ArchiveValidationSummary {
+	size_t games = 0;
+	size_t invalid_starts = 0;
+	size_t illegal_moves = 0;
+	size_t hash_mismatches = 0;
+	size_t plies = 0;
+
+	// false if the archive could not be read to the end.
+	bool complete = false;
+
+	// the replay time summed over the games, and the elapsed time. Their
+	// ratio is the number of threads that were kept busy.
+	std::chrono::nanoseconds replay_time { 0 };
+	std::chrono::nanoseconds wall_time { 0 };
+	std::chrono::nanoseconds slowest_time { 0 };
+	size_t slowest_game = 0;
+
+	size_t GetInvalidCount() const;
+};
+
+/**
+ * Replays every game of record files and checks each move against the
+ * possible moves of its position, and the final position against the hash
+ * in the record. The file is streamed in batches that are replayed on a
+ * thread pool. Results are written in the order of the games, one line per
+ * invalid game:
+ *
+ *   game 17 ply 4: illegal move e2e5 (0.812 ms)
+ *   game 20: final hash 0123456789abcdef, expected fedcba9876543210 (1.104 ms)
+ */
+class ArchiveValidator {
+
+public:
+	ArchiveValidator(const ArchiveValidatorSettings& settings);
+
+	ArchiveValidationSummary Validate(const std::string& file, std::ostream& out);
+
+	/**
+	 * Replays a single game.
+	 */
+	static GameValidation ValidateGame(const GameRecord& record, size_t gameIndex);
+
+	static void Write(const GameValidation& validation, std::ostream& out);
+	static void Write(const ArchiveValidationSummary& summary, std::ostream& out);
+
+private:
+	void _Add(const std::vector<GameValidation>& validations, ArchiveValidationSummary& summary, std::ostream& out) const;
+
+	ArchiveValidatorSettings _settings;
+
+};
+
+}
+
+#endif
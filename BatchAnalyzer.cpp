@@ -0,0 +1,211 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "BatchAnalyzer.h"
+
+#include "AiMcts.h"
+#include "Game.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+namespace ps {
+
+BatchAnalyzer::BatchAnalyzer(const BatchSettings& settings) :
+		_settings(settings) {
+
+	_settings.threads = std::max<size_t>(_settings.threads, 1);
+	_settings.window_per_thread = std::max<size_t>(_settings.window_per_thread, 1);
+}
+
+size_t BatchAnalyzer::Run(std::istream& in, std::ostream& out) {
+	_out = &out;
+	_tasks = {};
+	_pending.clear();
+	_next_output = 0;
+	_input_done = false;
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < _settings.threads; i++) {
+		workers.emplace_back(&BatchAnalyzer::_WorkerMain, this);
+	}
+
+	size_t window = _settings.threads * _settings.window_per_thread;
+	size_t index = 0;
+
+	for (std::string line; std::getline(in, line);) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+
+		if (line.empty()) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		// a slow position holds back the output, so the reader waits instead
+		// of letting the reordering buffer grow without bound.
+		_window_available.wait(lock, [this, index, window]() {
+			return index - _next_output < window;
+		});
+
+		_tasks.push({ index++, std::move(line) });
+		_task_available.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_input_done = true;
+	}
+
+	_task_available.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	return index;
+}
+
+void BatchAnalyzer::_WorkerMain() {
+	LastSearchStatisticsSink sink;
+	std::array<std::unique_ptr<AiMcts>, 2> players;
+
+	for (Piece::Color color : { Piece::Color::WHITE, Piece::Color::BLACK }) {
+		auto& player = players[color == Piece::Color::BLACK];
+		player = std::make_unique<AiMcts>(color, _settings.move_time, _settings.playouts, 0);
+		player->SetStatisticsSink(&sink);
+		player->SetTablebase(_settings.tablebase);
+
+		if (_settings.playouts > 0) {
+			player->SetMoveTime(std::chrono::hours(24));
+		}
+	}
+
+	while (true) {
+		_Task task;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_task_available.wait(lock, [this]() {
+				return !_tasks.empty() || _input_done;
+			});
+
+			if (_tasks.empty()) {
+				return;
+			}
+
+			task = std::move(_tasks.front());
+			_tasks.pop();
+		}
+
+		_Output(task.index, _Analyze(task, players, sink));
+	}
+}
+
+std::string BatchAnalyzer::_Analyze(const _Task& task, std::array<std::unique_ptr<AiMcts>, 2>& players, LastSearchStatisticsSink& sink) const {
+	std::ostringstream ss;
+	ss << "{\"index\":" << task.index << ",\"psfen\":\"" << _Escape(task.psFEN) << "\"";
+
+	Game game;
+	if (!game.SetState(task.psFEN)) {
+		ss << ",\"error\":\"invalid psfen\"}";
+		return ss.str();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	const Board& board = game.GetBoard();
+	Piece::Color color = game.GetPlayerColor();
+	auto possible = board.GetAllPossibleMoves(color, game.GetMoveData());
+
+	ss << ",\"legal_moves\":" << possible.size();
+
+	if (possible.empty()) {
+		ss << ",\"result\":\"" << (board.IsSako(color, game.GetMoveData()) ? "mate" : "stalemate") << "\"";
+	} else {
+		std::atomic_bool stop { false };
+		sink.Clear();
+
+		Move best = players[color == Piece::Color::BLACK]->MakeMove(board, game.GetMoveData(), possible, stop);
+		ss << ",\"best_move\":\"" << best.GetName() << "\"";
+
+		// the players have no opening book, so a move that was not searched is
+		// the only move or comes from the endgame tables. It has no score.
+		TablebaseResult result;
+		bool inTablebase = _settings.tablebase && _settings.tablebase->Probe(board, color, game.GetMoveData(), result);
+
+		if (sink.GetLast().player != Piece::Color::EMPTY) {
+			ss << ",\"source\":\"search\""
+					<< ",\"score\":" << sink.GetLast().score
+					<< ",\"depth\":" << sink.GetLast().depth;
+		} else if (possible.size() == 1) {
+			ss << ",\"source\":\"only_move\"";
+		} else {
+			ss << ",\"source\":\"tablebase\"";
+		}
+
+		if (inTablebase) {
+			ss << ",\"tablebase\":\"" << _OutcomeName(result.outcome) << "\"";
+
+			if (result.outcome != TablebaseResult::Outcome::DRAW) {
+				ss << ",\"distance\":" << result.distance;
+			}
+		}
+	}
+
+	auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	ss << ",\"time_ms\":" << time.count() << "}";
+
+	return ss.str();
+}
+
+void BatchAnalyzer::_Output(size_t index, std::string result) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_pending.emplace(index, std::move(result));
+
+	// write everything that is in order
+	bool written = false;
+	for (auto it = _pending.begin(); it != _pending.end() && it->first == _next_output; it = _pending.erase(it)) {
+		*_out << it->second << '\n';
+		_next_output++;
+		written = true;
+	}
+
+	if (written) {
+		_out->flush();
+		_window_available.notify_one();
+	}
+}
+
+std::string BatchAnalyzer::_Escape(const std::string& text) {
+	std::string escaped;
+
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+			escaped += c;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			char buffer[8];
+			std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+			escaped += buffer;
+		} else {
+			escaped += c;
+		}
+	}
+
+	return escaped;
+}
+
+const char *BatchAnalyzer::_OutcomeName(TablebaseResult::Outcome outcome) {
+	switch (outcome) {
+		case TablebaseResult::Outcome::WIN: return "win";
+		case TablebaseResult::Outcome::LOSS: return "loss";
+		default: return "draw";
+	}
+}
+
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef BATCHANALYZER_H_
+#define BATCHANALYZER_H_
+
+#include "SearchStatistics.h"
+#include "Tablebase.h"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <thread>
+
+namespace ps {
+
+class AiMcts;
+
+struct BatchSettings {
+	size_t threads = std::thread::hardware_concurrency();
+
+	// the limits of the search of each position. Without a playout limit, the
+	// move time is used.
+	std::chrono::milliseconds move_time { 1000 };
+	size_t playouts = 0;
+
+	// the number of positions that may be in flight per thread. The results
+	// of positions that finish early wait in the reordering buffer until all
+	// earlier positions are written.
+	size_t window_per_thread = 4;
+
+	// the endgame tables, which answer the positions they contain without a
+	// search.
+	const Tablebase *tablebase = nullptr;
+};
+
+/**
+ * Analyses a stream of PsFEN lines on a set of worker threads, and writes one
+ * JSON object per line for every position, in input order:
+ *
+ *   {"index":0,"psfen":"...","legal_moves":20,"best_move":"e2e4","source":"search","score":12,"depth":5,"time_ms":1000}
+ *
+ * The source is "search", "only_move" or "tablebase". Only a search has a
+ * score and a depth; a position in the endgame tables has its outcome
+ * instead, with the distance to mate of a win or loss:
+ *
+ *   {..."best_move":"a1a8","source":"tablebase","tablebase":"win","distance":3,...}
+ *
+ * Every worker has its own search players, so the workers share nothing but
+ * the input queue and the reordering buffer.
+ */
+class BatchAnalyzer {
+
+public:
+	BatchAnalyzer(const BatchSettings& settings);
+
+	/**
+	 * Analyses all lines of the input. Returns the number of positions.
+	 */
+	size_t Run(std::istream& in, std::ostream& out);
+
+private:
+	struct _Task {
+		size_t index;
+		std::string psFEN;
+	};
+
+	void _WorkerMain();
+	std::string _Analyze(const _Task& task, std::array<std::unique_ptr<AiMcts>, 2>& players, LastSearchStatisticsSink& sink) const;
+	void _Output(size_t index, std::string result);
+
+	static std::string _Escape(const std::string& text);
+	static const char *_OutcomeName(TablebaseResult::Outcome outcome);
+
+	BatchSettings _settings;
+	std::ostream *_out = nullptr;
+
+	std::mutex _mutex;
+	std::condition_variable _task_available;
+	std::condition_variable _window_available;
+	std::queue<_Task> _tasks;
+	bool _input_done = false;
+
+	// results that are waiting for an earlier position
+	std::map<size_t, std::string> _pending;
+	size_t _next_output = 0;
+
+};
+
+}
+
+#endif
@@ -3,12 +3,15 @@
  */
 #include "Board.h"
 
+#include "PsFEN.h"
+
 #include <algorithm>
-#include <sstream>
 #include <queue>
 
 namespace ps {
 
+static thread_local MoveGenerationProfile moveGenerationProfile;
+
 Board::Board() {
 	Board& b = *this;
 
@@ -42,110 +45,14 @@ Board::Board() {
 }
 
 std::string Board::GetPsFEN() const {
-	std::stringstream ss;
-
-	for (int r = 7; r >= 0; r--) {
-		if (r < 7) {
-			ss << '/';
-		}
-
-		int empty = 0;
-
-		for (int c = 0; c < 8; c++) {
-			const Piece& piece = GetPiece({ r, c });
-
-			if (piece.GetColor() == Piece::Color::EMPTY) {
-				empty++;
-				continue;
-			} else if (empty > 0) {
-				ss << empty;
-				empty = 0;
-			}
-
-			switch (piece.GetColor()) {
-				case Piece::Color::WHITE:
-					ss << getTypeCharWhite(piece.GetWhiteType());
-					break;
-				case Piece::Color::BLACK:
-					ss << getTypeCharBlack(piece.GetBlackType());
-					break;
-				case Piece::Color::UNION:
-					ss << 'U';
-					ss << getTypeCharWhite(piece.GetWhiteType());
-					ss << getTypeCharBlack(piece.GetBlackType());
-					break;
-				case Piece::Color::EMPTY:
-					break;
-			}
-		}
+	char buffer[PsFEN::MAX_LENGTH];
+	auto result = PsFEN::FormatBoard(buffer, buffer + sizeof(buffer), *this);
 
-		if (empty > 0) {
-			ss << empty;
-		}
-	}
-
-	return ss.str();
+	return std::string(buffer, result.ptr);
 }
 
-bool Board::SetPsFEN(const std::string& fen) {
-	if (fen.empty()) {
-		return false;
-	}
-
-	const char *arr = fen.c_str();
-
-	for (int r = 7; r >= 0; r--) {
-		int c = 0;
-
-		while (c < 8) {
-			if ('1' <= *arr && *arr <= '8') {
-				int count = *arr - '0';
-
-				for (int i = 0; i < count; i++) {
-					_squares[r][c] = Piece();
-					c++;
-				}
-
-				arr++;
-				continue;
-			}
-
-			if (*arr == 'U') {
-				arr++; auto whiteType = getTypeWhite(*arr);
-				arr++; auto blackType = getTypeBlack(*arr);
-				arr++;
-
-				if (whiteType == Piece::Type::NONE || blackType == Piece::Type::NONE) {
-					return false;
-				}
-
-				_squares[r][c] = Piece(whiteType, blackType);
-				c++;
-				continue;
-			}
-
-			auto whiteType = getTypeWhite(*arr);
-			auto blackType = getTypeBlack(*arr);
-
-			if (whiteType == Piece::Type::NONE && blackType == Piece::Type::NONE) {
-				return false;
-			}
-
-			_squares[r][c] = Piece(whiteType, blackType);
-			c++;
-			arr++;
-		}
-
-		if (r > 0 && *arr != '/') {
-			return false;
-		} else if (r == 0 && *arr != ' ') {
-			return false;
-		}
-
-		arr++;
-	}
-
-	return true;
+bool Board::SetPsFEN(std::string_view fen) {
+	return PsFEN::ParseBoard(fen, *this);
 }
 
 const Piece& Board::GetPiece(const BoardPosition& position) const {
@@ -172,6 +79,18 @@ std::vector<Move> Board::GetAllPossibleMoves(Piece::Color color, const GameMoveD
 	return _GetAllPossibleMoves(true, color, moveData);
 }
 
+bool Board::IsSako(Piece::Color color, const GameMoveData& moveData) const {
+	auto moves = _GetAllPossibleMoves(false, opposite(color), moveData);
+
+	return std::any_of(moves.begin(), moves.end(), [this, color](const auto& move) {
+		return GetPiece(move.GetPositions().back()).GetTypeOfColor(color) == Piece::Type::KING;
+	});
+}
+
+const MoveGenerationProfile& Board::GetMoveGenerationProfile() {
+	return moveGenerationProfile;
+}
+
 std::vector<BoardPosition> Board::CalculatePossibleMoves(const BoardPosition &piece, Piece::Color playerColor, const GameMoveData& moveData, bool checkSako) const {
 	return CalculatePossibleMoves(piece, GetPiece(piece), playerColor, moveData, checkSako);
 }
@@ -435,7 +354,6 @@ std::vector<Move> Board::_GetAllPossibleMoves(bool checkSako, Piece::Color color
 	std::vector<Move> moves;
 	std::vector<Move> temp;
 	Board dummy;
-	Piece::Color otherColor = opposite(color);
 
 	for (int r = 0; r < 8; r++) {
 		for (int c = 0; c < 8; c++) {
@@ -444,23 +362,25 @@ std::vector<Move> Board::_GetAllPossibleMoves(bool checkSako, Piece::Color color
 
 			if (piece.GetTypeOfColor(color) != Piece::Type::NONE) {
 				if (checkSako) {
+					auto start = std::chrono::steady_clock::now();
+
 					temp.clear();
 					_AddAllPossibleMoves(position, piece, color, temp, moveData, checkSako);
 
+					auto generated = std::chrono::steady_clock::now();
+
 					for (const Move& move : temp) {
 						dummy = *this;
 						move.PerformOn(dummy);
 
-						auto dummyMoves = dummy._GetAllPossibleMoves(false, otherColor, moveData);
-						bool sako = std::any_of(dummyMoves.begin(), dummyMoves.end(), [dummy, color](const auto& dummyMove) {
-							const auto& positions = dummyMove.GetPositions();
-							return dummy[positions.back()].GetTypeOfColor(color) == Piece::Type::KING;
-						});
-
-						if (!sako) {
+						if (!dummy.IsSako(color, moveData)) {
 							moves.push_back(std::move(move));
 						}
 					}
+
+					auto checked = std::chrono::steady_clock::now();
+					moveGenerationProfile.chain_generation += generated - start;
+					moveGenerationProfile.legality += checked - generated;
 				} else {
 					_AddAllPossibleMoves(position, piece, color, moves, moveData, checkSako);
 				}
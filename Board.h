@@ -9,6 +9,8 @@
 #include "Move.h"
 
 #include <array>
+#include <chrono>
+#include <string_view>
 #include <vector>
 #include <unordered_set>
 
@@ -16,13 +18,22 @@ namespace ps {
 
 struct ChainHashKey;
 
+/**
+ * The time spent by the move generator on a thread, split into generating the
+ * (chain) moves and checking them for legality.
+ */
+struct MoveGenerationProfile {
+	std::chrono::nanoseconds chain_generation { 0 };
+	std::chrono::nanoseconds legality { 0 };
+};
+
 class Board {
 
 public:
 	Board();
 
 	std::string GetPsFEN() const;
-	bool SetPsFEN(const std::string& fen);
+	bool SetPsFEN(std::string_view fen);
 
 	const Piece& GetPiece(const BoardPosition& position) const;
 	Piece& GetPiece(const BoardPosition& position);
@@ -33,6 +44,18 @@ public:
 	bool operator==(const Board& board) const;
 
 	std::vector<Move> GetAllPossibleMoves(Piece::Color color, const GameMoveData& moveData) const;
+
+	/**
+	 * Returns whether the king of the given color can be reached by a move of
+	 * the opponent.
+	 */
+	bool IsSako(Piece::Color color, const GameMoveData& moveData) const;
+
+	/**
+	 * Returns the move generation profile of the calling thread.
+	 */
+	static const MoveGenerationProfile& GetMoveGenerationProfile();
+
 	std::vector<BoardPosition> CalculatePossibleMoves(const BoardPosition& piece, Piece::Color playerColor, const GameMoveData& moveData, bool checkSako = true) const;
 	std::vector<BoardPosition> CalculatePossibleMoves(const BoardPosition& origin, const Piece& piece, Piece::Color playerColor, const GameMoveData& moveData, bool checkSako = true) const;
 
@@ -50,6 +73,8 @@ private:
 
 	std::array<std::array<Piece, 8>, 8> _squares {};
 
+	friend class PsFEN;
+
 };
 
 struct ChainHashKey {
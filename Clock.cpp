@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Clock.h"
+
+namespace ps {
+
+bool TimeControl::IsEnabled() const {
+	return initial.count() > 0;
+}
+
+Clock::Clock(const TimeControl& timeControl) :
+		_time_control(timeControl),
+		_remaining({ timeControl.initial, timeControl.initial }) {}
+
+const TimeControl& Clock::GetTimeControl() const {
+	return _time_control;
+}
+
+bool Clock::IsEnabled() const {
+	return _time_control.IsEnabled();
+}
+
+void Clock::Start(Piece::Color color) {
+	Stop();
+
+	_running = color;
+	_started = std::chrono::steady_clock::now();
+}
+
+void Clock::Stop() {
+	if (_running == Piece::Color::EMPTY) {
+		return;
+	}
+
+	Duration& remaining = _remaining[_running == Piece::Color::BLACK];
+	remaining -= std::chrono::steady_clock::now() - _started;
+
+	// a player who ran out of time stays flagged
+	if (remaining > Duration::zero()) {
+		remaining += _time_control.increment;
+	}
+
+	_running = Piece::Color::EMPTY;
+}
+
+Clock::Duration Clock::GetRemaining(Piece::Color color) const {
+	Duration remaining = _remaining[color == Piece::Color::BLACK];
+
+	if (color == _running) {
+		remaining -= std::chrono::steady_clock::now() - _started;
+	}
+
+	return remaining;
+}
+
+bool Clock::IsFlagged(Piece::Color color) const {
+	return IsEnabled() && GetRemaining(color) <= Duration::zero();
+}
+
+void Clock::SetRemaining(Piece::Color color, Duration remaining) {
+	_remaining[color == Piece::Color::BLACK] = remaining;
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "Piece.h"
+
+#include <array>
+#include <chrono>
+
+namespace ps {
+
+struct TimeControl {
+	// the time for each player at the start of the game. Zero means the game
+	// is played without a clock.
+	std::chrono::milliseconds initial { 0 };
+
+	// the time added to a player's clock after each of their moves.
+	std::chrono::milliseconds increment { 0 };
+
+	bool IsEnabled() const;
+};
+
+/**
+ * The clocks of both players, measured with a monotonic timer. At most one of
+ * the clocks is running at any time.
+ */
+class Clock {
+
+public:
+	using Duration = std::chrono::steady_clock::duration;
+
+public:
+	Clock(const TimeControl& timeControl = TimeControl());
+
+	const TimeControl& GetTimeControl() const;
+	bool IsEnabled() const;
+
+	/**
+	 * Starts the clock of the given player.
+	 */
+	void Start(Piece::Color color);
+
+	/**
+	 * Stops the running clock and adds the increment to it, unless the player
+	 * has run out of time.
+	 */
+	void Stop();
+
+	/**
+	 * Returns the time left for the given player, including the time spent so
+	 * far if their clock is running. This may be negative once the player has
+	 * run out of time.
+	 */
+	Duration GetRemaining(Piece::Color color) const;
+
+	bool IsFlagged(Piece::Color color) const;
+
+	/**
+	 * Sets the time left for the given player, for clocks that are kept by
+	 * someone else.
+	 */
+	void SetRemaining(Piece::Color color, Duration remaining);
+
+private:
+	TimeControl _time_control;
+	std::array<Duration, 2> _remaining;
+
+	Piece::Color _running = Piece::Color::EMPTY;
+	std::chrono::steady_clock::time_point _started;
+
+};
+
+}
+
+#endif
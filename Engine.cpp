@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Engine.h"
+
+#include <algorithm>
+
+namespace ps {
+
+Engine::_InfoSink::_InfoSink(Engine& engine) :
+		_engine(engine) {}
+
+void Engine::_InfoSink::ReportSearch(const SearchStatistics& statistics) {
+	std::ostringstream ss;
+
+	ss << "info time " << statistics.time.count() / 1000
+			<< " nodes " << statistics.nodes
+			<< " nps " << uint64_t(statistics.GetNodesPerSecond())
+			<< " playouts " << statistics.playouts
+			<< " depth " << statistics.depth
+			<< " seldepth " << statistics.selective_depth
+			<< " score cp " << statistics.score
+			<< " pv " << statistics.best_move.GetName();
+
+	_engine._Write(ss.str());
+}
+
+Engine::Engine(std::ostream& out, size_t threadCount) :
+		_out(out),
+		_thread_count(threadCount),
+		_info_sink(*this) {}
+
+Engine::~Engine() {
+	_Stop();
+}
+
+bool Engine::Execute(const std::string& line) {
+	std::istringstream in(line);
+	std::string command;
+	in >> command;
+
+	if (command == "psi") {
+		_Write(std::string("id name ") + _NAME);
+		_Write("psiok");
+	} else if (command == "isready") {
+		_Write("readyok");
+	} else if (command == "newgame") {
+		_Stop();
+		_players = {};
+	} else if (command == "position") {
+		_Stop();
+		_Position(in);
+	} else if (command == "go") {
+		_Stop();
+		_Go(in);
+	} else if (command == "stop") {
+		_Stop();
+	} else if (command == "quit") {
+		_Stop();
+		return false;
+	} else if (!command.empty()) {
+		_Write("info string unknown command " + command);
+	}
+
+	return true;
+}
+
+void Engine::_Position(std::istringstream& in) {
+	std::string token;
+	in >> token;
+
+	Game position;
+
+	if (token == "psfen") {
+		// the PsFEN has six fields separated by spaces
+		std::string psFEN, field;
+		for (int i = 0; i < 6 && in >> field; i++) {
+			psFEN += (i > 0 ? " " : "") + field;
+		}
+
+		if (!position.SetState(psFEN)) {
+			_Write("info string invalid psfen " + psFEN);
+			return;
+		}
+	} else if (token != "startpos") {
+		_Write("info string expected startpos or psfen");
+		return;
+	}
+
+	if (in >> token && token == "moves") {
+		while (in >> token) {
+			auto possible = position.GetBoard().GetAllPossibleMoves(position.GetPlayerColor(), position.GetMoveData());
+			auto found = std::find_if(possible.begin(), possible.end(), [&token](const Move& move) {
+				return move.GetName() == token;
+			});
+
+			if (found == possible.end()) {
+				_Write("info string illegal move " + token);
+				return;
+			}
+
+			position.MakeMove(*found);
+		}
+	}
+
+	_position = position;
+}
+
+void Engine::_Go(std::istringstream& in) {
+	std::chrono::milliseconds moveTime(0);
+	std::array<std::chrono::milliseconds, 2> time {}, increment {};
+	size_t playouts = 0;
+	bool infinite = false;
+
+	for (std::string token; in >> token;) {
+		int64_t value = 0;
+
+		if (token == "infinite") {
+			infinite = true;
+			continue;
+		}
+
+		if (!(in >> value)) {
+			break;
+		}
+
+		if (token == "movetime") moveTime = std::chrono::milliseconds(value);
+		else if (token == "wtime") time[0] = std::chrono::milliseconds(value);
+		else if (token == "btime") time[1] = std::chrono::milliseconds(value);
+		else if (token == "winc") increment[0] = std::chrono::milliseconds(value);
+		else if (token == "binc") increment[1] = std::chrono::milliseconds(value);
+		else if (token == "playouts") playouts = size_t(value);
+	}
+
+	Piece::Color color = _position.GetPlayerColor();
+	int side = color == Piece::Color::BLACK;
+	AiMcts& player = _GetPlayer(color);
+
+	// the clock is kept by the caller; the player only needs to see the time
+	// that is left for this move.
+	if (time[side].count() > 0 && !infinite && moveTime.count() == 0) {
+		_clock = Clock({ time[side], increment[side] });
+		_clock.SetRemaining(Piece::Color::WHITE, time[0]);
+		_clock.SetRemaining(Piece::Color::BLACK, time[1]);
+		player.SetClock(&_clock);
+	} else {
+		player.SetClock(nullptr);
+		player.SetMoveTime(infinite || (moveTime.count() == 0 && playouts > 0) ?
+				std::chrono::milliseconds(_INFINITE_MOVE_TIME) : moveTime.count() > 0 ? moveTime : std::chrono::milliseconds(1000));
+	}
+
+	player.SetPositionHistory(&_position.GetHistory());
+
+	player.SetMaxPlayouts(playouts);
+
+	_stop.store(false);
+	_search_thread = std::make_unique<std::thread>([this, &player]() {
+		const Board& board = _position.GetBoard();
+		auto possible = board.GetAllPossibleMoves(_position.GetPlayerColor(), _position.GetMoveData());
+
+		if (possible.empty()) {
+			_Write("bestmove (none)");
+			return;
+		}
+
+		Move move = player.MakeMove(board, _position.GetMoveData(), possible, _stop);
+		_Write("bestmove " + move.GetName());
+	});
+}
+
+void Engine::_Stop() {
+	if (!_search_thread) {
+		return;
+	}
+
+	_stop.store(true);
+	_search_thread->join();
+	_search_thread.reset();
+}
+
+AiMcts& Engine::_GetPlayer(Piece::Color color) {
+	std::unique_ptr<AiMcts>& player = _players[color == Piece::Color::BLACK];
+
+	if (!player) {
+		player = std::make_unique<AiMcts>(color, std::chrono::milliseconds(1000), 0, _thread_count);
+		player->SetStatisticsSink(&_info_sink);
+	}
+
+	return *player;
+}
+
+void Engine::_Write(const std::string& line) {
+	std::lock_guard<std::mutex> lock(_out_mutex);
+	_out << line << std::endl;
+}
+
+}
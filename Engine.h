@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef ENGINE_H_
+#define ENGINE_H_
+
+#include "AiMcts.h"
+#include "Clock.h"
+#include "Game.h"
+#include "SearchStatistics.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace ps {
+
+/**
+ * A line-based text protocol for playing out of process. Commands are read
+ * one line at a time, and the responses are written to the output stream:
+ *
+ *   psi                                   id name ..., psiok
+ *   isready                               readyok
+ *   newgame                               forgets the search trees
+ *   position startpos [moves <move>...]
+ *   position psfen <PsFEN> [moves <move>...]
+ *   go [movetime <ms>] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>]
+ *      [playouts <n>] [infinite]          info ..., bestmove <move>
+ *   stop                                  stops the search
+ *   quit
+ *
+ * Moves are written as the names of their positions without separators, as
+ * returned by Move::GetName(). The search runs on its own thread, so that
+ * stop can be received while it is thinking.
+ */
+class Engine {
+
+public:
+	Engine(std::ostream& out, size_t threadCount = std::thread::hardware_concurrency());
+	~Engine();
+
+	Engine(const Engine&) = delete;
+	Engine& operator=(const Engine&) = delete;
+
+	/**
+	 * Executes a command. Returns false if the command was quit.
+	 */
+	bool Execute(const std::string& line);
+
+private:
+	class _InfoSink : public StatisticsSink {
+
+	public:
+		_InfoSink(Engine& engine);
+
+		void ReportSearch(const SearchStatistics& statistics) override;
+		void ReportMove(const Move& move, const std::string& psFEN) override {}
+
+	private:
+		Engine& _engine;
+
+	};
+
+	void _Position(std::istringstream& in);
+	void _Go(std::istringstream& in);
+	void _Stop();
+
+	AiMcts& _GetPlayer(Piece::Color color);
+	void _Write(const std::string& line);
+
+	std::ostream& _out;
+	std::mutex _out_mutex;
+
+	size_t _thread_count;
+	_InfoSink _info_sink;
+	std::array<std::unique_ptr<AiMcts>, 2> _players;
+
+	Game _position;
+	Clock _clock;
+
+	std::unique_ptr<std::thread> _search_thread;
+	std::atomic_bool _stop { false };
+
+private:
+	static constexpr auto _NAME = "Paco Sako";
+	static constexpr int64_t _INFINITE_MOVE_TIME = 24 * 60 * 60 * 1000;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Evaluator.h"
+
+namespace ps {
+
+const Evaluator::Weights Evaluator::DEFAULT_WEIGHTS = {
+	// material
+	{ 0, 100, 500, 320, 330, 900, 0 },
+
+	// piece-square tables
+	{ {
+		// none
+		{},
+
+		// pawn
+		{
+			  0,   0,   0,   0,   0,   0,   0,   0,
+			 50,  50,  50,  50,  50,  50,  50,  50,
+			 10,  10,  20,  30,  30,  20,  10,  10,
+			  5,   5,  10,  25,  25,  10,   5,   5,
+			  0,   0,   0,  20,  20,   0,   0,   0,
+			  5,  -5, -10,   0,   0, -10,  -5,   5,
+			  5,  10,  10, -20, -20,  10,  10,   5,
+			  0,   0,   0,   0,   0,   0,   0,   0
+		},
+
+		// rook
+		{
+			  0,   0,   0,   0,   0,   0,   0,   0,
+			  5,  10,  10,  10,  10,  10,  10,   5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			  0,   0,   0,   5,   5,   0,   0,   0
+		},
+
+		// knight
+		{
+			-50, -40, -30, -30, -30, -30, -40, -50,
+			-40, -20,   0,   0,   0,   0, -20, -40,
+			-30,   0,  10,  15,  15,  10,   0, -30,
+			-30,   5,  15,  20,  20,  15,   5, -30,
+			-30,   0,  15,  20,  20,  15,   0, -30,
+			-30,   5,  10,  15,  15,  10,   5, -30,
+			-40, -20,   0,   5,   5,   0, -20, -40,
+			-50, -40, -30, -30, -30, -30, -40, -50
+		},
+
+		// bishop
+		{
+			-20, -10, -10, -10, -10, -10, -10, -20,
+			-10,   0,   0,   0,   0,   0,   0, -10,
+			-10,   0,   5,  10,  10,   5,   0, -10,
+			-10,   5,   5,  10,  10,   5,   5, -10,
+			-10,   0,  10,  10,  10,  10,   0, -10,
+			-10,  10,  10,  10,  10,  10,  10, -10,
+			-10,   5,   0,   0,   0,   0,   5, -10,
+			-20, -10, -10, -10, -10, -10, -10, -20
+		},
+
+		// queen
+		{
+			-20, -10, -10,  -5,  -5, -10, -10, -20,
+			-10,   0,   0,   0,   0,   0,   0, -10,
+			-10,   0,   5,   5,   5,   5,   0, -10,
+			 -5,   0,   5,   5,   5,   5,   0,  -5,
+			  0,   0,   5,   5,   5,   5,   0,  -5,
+			-10,   5,   5,   5,   5,   5,   0, -10,
+			-10,   0,   5,   0,   0,   0,   0, -10,
+			-20, -10, -10,  -5,  -5, -10, -10, -20
+		},
+
+		// king
+		{
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-20, -30, -30, -40, -40, -30, -30, -20,
+			-10, -20, -20, -20, -20, -20, -20, -10,
+			 20,  20,   0,   0,   0,   0,  20,  20,
+			 20,  30,  10,   0,   0,  10,  30,  20
+		}
+	} },
+
+	// union halves: a half of a union can be moved along with the opponent's
+	// half, and be freed again by a chain, so stronger halves are worth more.
+	{ 0, 10, 20, 15, 15, 30, 0 }
+};
+
+Evaluator::Evaluator(const Weights& weights) :
+		_weights(&weights) {
+
+	Reset(_board);
+}
+
+Evaluator::Evaluator(const Board& board, const Weights& weights) :
+		_weights(&weights) {
+
+	Reset(board);
+}
+
+void Evaluator::Reset(const Board& board) {
+	_board = board;
+	_material = {};
+	_psq = {};
+	_union = {};
+
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			_Add({ r, c }, _board[{ r, c }], 1);
+		}
+	}
+}
+
+void Evaluator::MakeMove(Board& board, const Move& move) {
+	Update(board, move.PerformOn(board));
+}
+
+void Evaluator::Update(const Board& board, const std::vector<SubMove>& submoves) {
+	// every square that was changed by the move is either the start or the
+	// end of a sub move, so only those squares need to be updated.
+	for (const SubMove& submove : submoves) {
+		_UpdateSquare(board, submove.start_position);
+		_UpdateSquare(board, submove.end_position);
+	}
+}
+
+int Evaluator::Evaluate(Piece::Color color) const {
+	int white = _material[0] + _psq[0] + _union[0];
+	int black = _material[1] + _psq[1] + _union[1];
+
+	return color == Piece::Color::BLACK ? black - white : white - black;
+}
+
+int Evaluator::GetMaterial(Piece::Color color) const {
+	return _material[color == Piece::Color::BLACK];
+}
+
+int Evaluator::GetPieceSquare(Piece::Color color) const {
+	return _psq[color == Piece::Color::BLACK];
+}
+
+int Evaluator::GetUnion(Piece::Color color) const {
+	return _union[color == Piece::Color::BLACK];
+}
+
+void Evaluator::_UpdateSquare(const Board& board, const BoardPosition& position) {
+	Piece& old = _board[position];
+	const Piece& current = board[position];
+
+	if (old == current) {
+		return;
+	}
+
+	_Add(position, old, -1);
+	_Add(position, current, 1);
+	old = current;
+}
+
+void Evaluator::_Add(const BoardPosition& position, const Piece& piece, int sign) {
+	bool inUnion = piece.GetColor() == Piece::Color::UNION;
+
+	if (piece.GetWhiteType() != Piece::Type::NONE) {
+		int square = (7 - position.GetRow()) * 8 + position.GetColumn();
+		_AddHalf(0, piece.GetWhiteType(), square, inUnion, sign);
+	}
+
+	if (piece.GetBlackType() != Piece::Type::NONE) {
+		int square = position.GetRow() * 8 + position.GetColumn();
+		_AddHalf(1, piece.GetBlackType(), square, inUnion, sign);
+	}
+}
+
+void Evaluator::_AddHalf(int side, Piece::Type type, int square, bool inUnion, int sign) {
+	size_t t = size_t(type);
+
+	_material[side] += sign * _weights->material[t];
+	_psq[side] += sign * _weights->psq[t][square];
+
+	if (inUnion) {
+		_union[side] += sign * _weights->union_half[t];
+	}
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef EVALUATOR_H_
+#define EVALUATOR_H_
+
+#include "Board.h"
+#include "Move.h"
+
+#include <array>
+
+namespace ps {
+
+/**
+ * A static evaluation of a board, kept up to date incrementally. Instead of
+ * scanning all squares for every evaluation, the evaluator holds material,
+ * piece-square and union accumulators for both sides and only updates the
+ * squares that were touched by a move.
+ */
+class Evaluator {
+
+public:
+	struct Weights {
+		// the value of a piece, indexed by Piece::Type.
+		std::array<int, 7> material;
+
+		// the piece-square tables, indexed by Piece::Type and square. The
+		// squares are laid out like a diagram from the white side, with the
+		// eighth rank first. The rows are mirrored for black.
+		std::array<std::array<int, 64>, 7> psq;
+
+		// the value of controlling the half of a union of the given type,
+		// indexed by Piece::Type.
+		std::array<int, 7> union_half;
+	};
+
+	static const Weights DEFAULT_WEIGHTS;
+
+public:
+	Evaluator(const Weights& weights = DEFAULT_WEIGHTS);
+	Evaluator(const Board& board, const Weights& weights = DEFAULT_WEIGHTS);
+
+	/**
+	 * Recalculates all accumulators from scratch.
+	 */
+	void Reset(const Board& board);
+
+	/**
+	 * Performs the move on the board and updates the accumulators for the
+	 * squares that were changed by the move.
+	 */
+	void MakeMove(Board& board, const Move& move);
+
+	/**
+	 * Updates the accumulators after the sub moves were performed on the board
+	 * by the caller. The board must be the board the evaluator was tracking,
+	 * with the moves applied.
+	 */
+	void Update(const Board& board, const std::vector<SubMove>& submoves);
+
+	/**
+	 * Returns the score of the position in centipawns, from the perspective of
+	 * the given player.
+	 */
+	int Evaluate(Piece::Color color) const;
+
+	int GetMaterial(Piece::Color color) const;
+	int GetPieceSquare(Piece::Color color) const;
+	int GetUnion(Piece::Color color) const;
+
+private:
+	void _UpdateSquare(const Board& board, const BoardPosition& position);
+	void _Add(const BoardPosition& position, const Piece& piece, int sign);
+	void _AddHalf(int side, Piece::Type type, int square, bool inUnion, int sign);
+
+	const Weights *_weights;
+
+	// the board as last seen by the accumulators.
+	Board _board;
+
+	// accumulators, indexed by side (0 is white, 1 is black).
+	std::array<int, 2> _material {};
+	std::array<int, 2> _psq {};
+	std::array<int, 2> _union {};
+
+};
+
+}
+
+#endif
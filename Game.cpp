@@ -3,16 +3,18 @@
  */
 #include "Game.h"
 
+#include "Zobrist.h"
+
+#include <algorithm>
 #include <cassert>
+#include <iostream>
 #include <unordered_set>
 
-#include "PlayerHuman.h"
-#include "Window.h"
-
 namespace ps {
 
 Game::Game() {
 	_board = std::make_unique<Board>();
+	_ResetPlies();
 }
 
 Game::~Game() {
@@ -21,23 +23,40 @@ Game::~Game() {
 	}
 
 	_game_thread_close.store(true);
+	_InterruptPlayers();
 	_game_thread->join();
 }
 
 Game::Game(const Game& game) noexcept :
 	_board(std::make_unique<Board>(*game._board)),
 	_current_player(std::move(game._current_player)),
+	_result(game._result),
+	_clock(game._clock),
 	_move_data(std::move(game._move_data)),
 	_fify_move_rule_count(std::move(game._fify_move_rule_count)),
-	_current_move(std::move(game._current_move)) {
+	_current_move(std::move(game._current_move)),
+	_history(game._history),
+	_plies(game._plies),
+	_changes(game._changes),
+	_ply(game._ply),
+	_hashes(game._hashes),
+	_hash_offset(game._hash_offset) {
 }
 
 Game& Game::operator=(const Game& game) noexcept {
 	_board = std::make_unique<Board>(*game._board);
 	_current_player = std::move(game._current_player);
+	_result = game._result;
+	_clock = game._clock;
 	_move_data = std::move(game._move_data);
 	_fify_move_rule_count = std::move(game._fify_move_rule_count);
 	_current_move = std::move(game._current_move);
+	_history = game._history;
+	_plies = game._plies;
+	_changes = game._changes;
+	_ply = game._ply;
+	_hashes = game._hashes;
+	_hash_offset = game._hash_offset;
 
 	return *this;
 }
@@ -45,127 +64,169 @@ Game& Game::operator=(const Game& game) noexcept {
 void Game::SetPlayers(Player *white, Player *black) {
 	_player_white = std::unique_ptr<Player>(white);
 	_player_black = std::unique_ptr<Player>(black);
+
+	_player_white->SetStatisticsSink(_statistics_sink);
+	_player_black->SetStatisticsSink(_statistics_sink);
+
+	_player_white->SetClock(_clock.IsEnabled() ? &_clock : nullptr);
+	_player_black->SetClock(_clock.IsEnabled() ? &_clock : nullptr);
+
+	_player_white->SetPositionHistory(&_history);
+	_player_black->SetPositionHistory(&_history);
 }
 
-bool Game::SetState(const std::string &psFEN) {
-	// Read the board
-	if (!_board->SetPsFEN(psFEN)) {
-		return false;
+void Game::SetStatisticsSink(StatisticsSink *sink) {
+	_statistics_sink = sink;
+
+	if (_player_white) {
+		_player_white->SetStatisticsSink(sink);
 	}
 
-	_move_data = GameMoveData();
-	_move_data.can_white_castle_king_side = false;
-	_move_data.can_white_castle_queen_side = false;
-	_move_data.can_black_castle_king_side = false;
-	_move_data.can_black_castle_queen_side = false;
+	if (_player_black) {
+		_player_black->SetStatisticsSink(sink);
+	}
+}
 
-	size_t boardEnd = psFEN.find(' ');
-	const char *arr = psFEN.c_str() + boardEnd + 1;
+void Game::SetState(const Board& board, const GameMoveData& moveData, Piece::Color currentPlayer) {
+	*_board = board;
+	_move_data = moveData;
+	_current_player = currentPlayer;
+	_result = Result::NONE;
+	_fify_move_rule_count = 0;
+	_current_move = 1;
 
-	// read the current player
-	if (*arr == 'w') {
-		_current_player = Piece::Color::WHITE;
-	} else if (*arr == 'b') {
-		_current_player = Piece::Color::BLACK;
-	} else {
-		return false;
+	_ResetPlies();
+}
+
+void Game::SetTimeControl(const TimeControl& timeControl) {
+	_clock = Clock(timeControl);
+
+	if (_player_white && _player_black) {
+		_player_white->SetClock(_clock.IsEnabled() ? &_clock : nullptr);
+		_player_black->SetClock(_clock.IsEnabled() ? &_clock : nullptr);
 	}
+}
 
-	if (*(arr + 1) != ' ') {
+const Clock& Game::GetClock() const {
+	return _clock;
+}
+
+bool Game::SetState(std::string_view psFEN, PsFENError *error) {
+	if (!PsFEN::Parse(psFEN, *_board, _current_player, _move_data, _fify_move_rule_count, _current_move, error)) {
 		return false;
 	}
 
+	_result = Result::NONE;
 
-	// read the castling possibilities
-	arr += 2;
-
-	if (*arr == '-') {
-		if (*(arr + 1) != ' ') {
-			return false;
-		}
+	_ResetPlies();
+	return true;
+}
 
-		arr += 2;
-	} else {
-		if (*arr != 'K' && *arr != 'Q' && *arr != 'k' && *arr != 'q') { return false; }
-		if (*arr == 'K') { _move_data.can_white_castle_king_side  = true; arr++; }
+void Game::StartThread(GameListener *listener) {
+	assert(_player_white && _player_black);
 
-		if (*arr != 'Q' && *arr != 'k' && *arr != 'q' && *arr != ' ') { return false; }
-		if (*arr == 'Q') { _move_data.can_white_castle_queen_side = true; arr++; }
+	_game_thread = std::unique_ptr<std::thread>(new std::thread([listener](Game *game){
+		game->Play(listener);
+	}, this));
+}
 
-		if (*arr != 'k' && *arr != 'q' && *arr != ' ') { return false; }
-		if (*arr == 'k') { _move_data.can_black_castle_king_side  = true; arr++; }
+void Game::Play(GameListener *listener) {
+	while (PlayTurn(listener) == TurnResult::MOVED) {}
+}
 
-		if (*arr != 'q' && *arr != ' ') { return false; }
-		if (*arr == 'q') { _move_data.can_black_castle_queen_side = true; arr++; }
+Game::TurnResult Game::PlayTurn(GameListener *listener, const std::function<void()>& wake) {
+	assert(_player_white && _player_black);
 
-		if (*arr != ' ') { return false; }
-		arr++;
+	if (_game_thread_close) {
+		return TurnResult::OVER;
 	}
 
-	// read the en passant position
-	if (*arr == '-') {
-		if (*(arr + 1) != ' ') {
-			return false;
-		}
-
-		arr += 2;
-	} else {
-		int ep[2] = { *arr, *(arr + 1) };
-		ep[0] -= 'a';
-		ep[1] -= '1';
+	// check that moves are possible
+	const auto& allMoves = _board->GetAllPossibleMoves(_current_player, _move_data);
 
-		if (ep[0] < 0 || ep[0] > 7 || ep[1] < 0 || ep[1] > 7) {
-			return false;
+	if (allMoves.empty()) {
+		// either mate or stalemate
+		if (_board->IsSako(_current_player, _move_data)) {
+			std::cout << "Mate" << std::endl;
+			_result = _current_player == Piece::Color::WHITE ? Result::BLACK_WINS : Result::WHITE_WINS;
+			listener->Mate();
+		} else {
+			std::cout << "Stalemate" << std::endl;
+			_result = Result::DRAW;
+			listener->Stalemate();
 		}
 
-		if (*(arr + 2) != ' ') {
-			return false;
-		}
+		return TurnResult::OVER;
+	}
 
-		if (ep[1] <= 3) {
-			ep[1]++;
-		} else {
-			ep[1]--;
+	// check that not all pieces are a union
+	int unionCount = 0;
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			if (_board->GetPiece({ r, c }).GetColor() == Piece::Color::UNION) {
+				unionCount++;
+			}
 		}
-
-		_move_data.en_passant_position = { ep[1], ep[0] };
-		arr += 3;
 	}
 
-	// read the move counts
-	char *end;
-	_fify_move_rule_count = strtol(arr, &end, 10);
+	if (unionCount == 15) {
+		std::cout << "Stalemate" << std::endl;
+		_result = Result::DRAW;
+		listener->Stalemate();
+		return TurnResult::OVER;
+	}
 
-	if (end == arr) {
-		return false;
+	if (IsRepetition()) {
+		_result = Result::DRAW;
+		listener->Repetition();
+		return TurnResult::OVER;
 	}
 
-	arr = end;
-	if (*arr != ' ') {
-		return false;
+	bool isWhite = _current_player == Piece::Color::WHITE;
+	Player& player = isWhite ? *_player_white : *_player_black;
+	Player& opponent = isWhite ? *_player_black : *_player_white;
+
+	bool resumed = _move_requested;
+	_move_requested = false;
+
+	if (!resumed && _clock.IsEnabled()) {
+		_clock.Start(_current_player);
 	}
-	arr++;
 
-	_current_move = strtol(arr, &end, 10);
+	// a player that waits for its move gives up the thread until it is woken
+	if (!resumed && wake && !player.RequestMove(*_board, _move_data, wake)) {
+		_move_requested = true;
+		return TurnResult::PARKED;
+	}
 
-	if (end == arr) {
-		return false;
+	// let the opponent think along while the current player is thinking. A
+	// resumed turn has its move already.
+	if (!resumed) {
+		opponent.StartPondering(*_board, _move_data);
 	}
 
-	arr = end;
-	if (*arr != 0) {
-		return false;
+	bool moved = _MakeMove(allMoves, player, listener);
+
+	if (!resumed) {
+		opponent.StopPondering();
 	}
 
-	return true;
+	return moved ? TurnResult::MOVED : TurnResult::OVER;
 }
 
-void Game::StartThread(Window *window) {
-	assert(_player_white && _player_black);
+void Game::Stop() {
+	_game_thread_close.store(true);
+	_InterruptPlayers();
+}
 
-	_game_thread = std::unique_ptr<std::thread>(new std::thread([window](Game *game){
-		game->_Loop(window);
-	}, this));
+void Game::Adjudicate(Result result) {
+	_result = result;
+	_game_thread_close.store(true);
+	_InterruptPlayers();
+}
+
+Game::Result Game::GetResult() const {
+	return _result;
 }
 
 const Board& Game::GetBoard() const {
@@ -188,12 +249,35 @@ void Game::SwitchPlayerColor() {
 	}
 }
 
-void Game::MakeMove(const Move& move) {
+int Game::GetFiftyMoveRuleCount() const {
+	return _fify_move_rule_count;
+}
+
+int Game::GetMoveNumber() const {
+	return _current_move;
+}
+
+void Game::SetMoveCounters(int fiftyMoveRuleCount, int moveNumber) {
+	_fify_move_rule_count = fiftyMoveRuleCount;
+	_current_move = moveNumber;
+}
+
+std::vector<SubMove> Game::MakeMove(const Move& move) {
 	const auto& positions = move.GetPositions();
 	if (positions.empty()) {
-		return;
+		return {};
 	}
 
+	// a new move discards the moves that were undone
+	if (_ply < GetPlyCount()) {
+		_plies.erase(_plies.begin() + _ply, _plies.end());
+		_changes.erase(_changes.begin() + ptrdiff_t(_plies.empty() ? 0 : _plies.back().first_change + _plies.back().change_count), _changes.end());
+		_hashes.erase(_hashes.begin() + ptrdiff_t(_hash_offset + size_t(_ply) + 1), _hashes.end());
+	}
+
+	_State before = _GetState();
+	Board premove = *_board;
+
 	Piece movingPiece = _board->GetPiece(positions.front());
 
 	// count the number of pawns before the move for pawn promotion detection
@@ -205,7 +289,7 @@ void Game::MakeMove(const Move& move) {
 	}
 
 	_move_data.en_passant_position = { -1, -1 };
-	move.PerformOn(*_board);
+	std::vector<SubMove> submoves = move.PerformOn(*_board);
 
 	if (positions.size() >= 2) {
 		const BoardPosition& prev = *(positions.end() - 2);
@@ -261,9 +345,11 @@ void Game::MakeMove(const Move& move) {
 
 	// check if a non-reversible move was made (only creating a union or pawn
 	// promotion are non-reversible moves in paco sako.
-	if (whitePawnCount != 0 || blackPawnCount || (positions.size() == 2 && movingPiece.GetColor() != Piece::Color::UNION &&
-			_board->GetPiece(positions.back()).GetColor() == Piece::Color::UNION)) {
+	bool irreversible = whitePawnCount != 0 || blackPawnCount || (positions.size() == 2 &&
+			movingPiece.GetColor() != Piece::Color::UNION &&
+			_board->GetPiece(positions.back()).GetColor() == Piece::Color::UNION);
 
+	if (irreversible) {
 		_fify_move_rule_count = 0;
 	} else {
 		_fify_move_rule_count++;
@@ -275,124 +361,220 @@ void Game::MakeMove(const Move& move) {
 	if (_current_player == Piece::Color::WHITE) {
 		_current_move++;
 	}
-}
 
-std::string Game::GetPsFEN() const {
-	std::string boardFEN = _board->GetPsFEN();
-	boardFEN += ' ';
+	// no position before an irreversible move can occur again
+	if (irreversible) {
+		_history.Clear();
+	}
 
-	if (_current_player == Piece::Color::WHITE) {
-		boardFEN += 'w';
-	} else {
-		boardFEN += 'b';
+	_history.Push(_Hash());
+	_hashes.push_back(_history.GetLast());
+
+	// remember the squares that were changed, to undo and redo the move
+	_Ply ply { move, _changes.size(), 0, before, _GetState(),
+			irreversible ? _hashes.size() - 1 : _ply == 0 ? 0 : _plies.back().history_start };
+
+	for (const SubMove& submove : submoves) {
+		for (const BoardPosition& position : { submove.start_position, submove.end_position }) {
+			auto first = _changes.begin() + ptrdiff_t(ply.first_change);
+			auto found = std::find_if(first, _changes.end(), [&position](const _SquareChange& change) {
+				return change.position == position;
+			});
+
+			if (found == _changes.end()) {
+				_changes.push_back({ position, premove[position], (*_board)[position] });
+			} else {
+				found->after = (*_board)[position];
+			}
+		}
 	}
 
-	boardFEN += ' ';
+	ply.change_count = _changes.size() - ply.first_change;
+	_plies.push_back(std::move(ply));
+	_ply++;
 
-	if (_move_data.can_white_castle_king_side || _move_data.can_white_castle_queen_side ||
-			_move_data.can_black_castle_king_side || _move_data.can_black_castle_queen_side) {
+	return submoves;
+}
 
-		if (_move_data.can_white_castle_king_side) boardFEN += 'K';
-		if (_move_data.can_white_castle_queen_side) boardFEN += 'Q';
-		if (_move_data.can_black_castle_king_side) boardFEN += 'k';
-		if (_move_data.can_black_castle_queen_side) boardFEN += 'q';
+bool Game::Undo() {
+	if (_ply == 0) {
+		return false;
+	}
 
-		boardFEN += ' ';
-	} else {
-		boardFEN += "- ";
+	_Undo();
+	_RestoreHistory();
+	return true;
+}
+
+bool Game::Redo() {
+	if (_ply == GetPlyCount()) {
+		return false;
 	}
 
-	BoardPosition ep = _move_data.en_passant_position;
+	_Redo();
+	_RestoreHistory();
+	return true;
+}
 
-	if (ep.IsValid()) {
-		if (ep.GetRow() <= 3) {
-			ep = { ep.GetRow() - 1, ep.GetColumn() };
-		} else {
-			ep = { ep.GetRow() + 1, ep.GetColumn() };
-		}
+bool Game::GoTo(int ply) {
+	if (ply < 0 || ply > GetPlyCount()) {
+		return false;
+	}
 
-		boardFEN += ep.GetName();
-		boardFEN += ' ';
-	} else {
-		boardFEN += "- ";
+	while (_ply > ply) {
+		_Undo();
 	}
 
-	boardFEN += std::to_string(_fify_move_rule_count);
-	boardFEN += ' ';
-	boardFEN += std::to_string(_current_move);
+	while (_ply < ply) {
+		_Redo();
+	}
 
-	return boardFEN;
+	_RestoreHistory();
+	return true;
 }
 
-void Game::_Loop(Window *window) {
-	bool isWhitePlayerHuman = (bool) dynamic_cast<PlayerHuman *>(_player_white.get());
-	bool isBlackPlayerHuman = (bool) dynamic_cast<PlayerHuman *>(_player_black.get());
+int Game::GetPly() const {
+	return _ply;
+}
 
-	while (!_game_thread_close) {
-		// check that moves are possible
-		const auto& allMoves = _board->GetAllPossibleMoves(_current_player, _move_data);
+int Game::GetPlyCount() const {
+	return int(_plies.size());
+}
 
-		if (allMoves.empty()) {
-			// either mate or stalemate
-			const auto& oppositeMoves = _board->GetAllPossibleMoves(opposite(_current_player), _move_data);
-			if (std::any_of(oppositeMoves.begin(), oppositeMoves.end(), [this, window](const auto& move) {
-				return _board->GetPiece(move.GetPositions().back()).GetTypeOfColor(_current_player) == Piece::Type::KING;
-			})) {
-				std::cout << "Mate" << std::endl;
-				window->Mate();
-			} else {
-				std::cout << "Stalemate" << std::endl;
-				window->Stalemate();
-			}
+const Move& Game::GetMove(int ply) const {
+	return _plies[size_t(ply)].move;
+}
 
-			break;
-		}
+int Game::GetRepetitionCount() const {
+	return _history.GetLastCount();
+}
 
-		// check that not all pieces are a union
-		int unionCount = 0;
-		for (int r = 0; r < 8; r++) {
-			for (int c = 0; c < 8; c++) {
-				if (_board->GetPiece({ r, c }).GetColor() == Piece::Color::UNION) {
-					unionCount++;
-				}
-			}
-		}
+bool Game::IsRepetition(int count) const {
+	return GetRepetitionCount() >= count;
+}
 
-		if (unionCount == 15) {
-			std::cout << "Stalemate" << std::endl;
-			window->Stalemate();
-			break;
-		}
+const PositionHistory& Game::GetHistory() const {
+	return _history;
+}
 
-		if (_current_player == Piece::Color::WHITE) {
-			if (!_MakeMove(allMoves, *_player_white, window, isWhitePlayerHuman)) {
-				break;
-			}
-		} else {
-			if (!_MakeMove(allMoves, *_player_black, window, isBlackPlayerHuman)) {
-				break;
-			}
-		}
+void Game::SetHistory(const PositionHistory& history) {
+	assert(!history.IsEmpty() && history.GetLast() == _Hash());
+
+	_ResetPlies();
+	_history = history;
+
+	_hashes.clear();
+	for (size_t i = 0; i < history.GetSize(); i++) {
+		_hashes.push_back(history.GetHash(i));
 	}
+
+	_hash_offset = _hashes.size() - 1;
 }
 
-bool Game::_MakeMove(const std::vector<Move>& possible, Player& player, Window *window, bool isHuman) {
+std::string Game::GetPsFEN() const {
+	char buffer[PsFEN::MAX_LENGTH];
+	auto result = PsFEN::Format(buffer, buffer + sizeof(buffer), *_board, _current_player, _move_data,
+			_fify_move_rule_count, _current_move);
+
+	return std::string(buffer, result.ptr);
+}
+
+bool Game::_MakeMove(const std::vector<Move>& possible, Player& player, GameListener *listener) {
 	Move move = player.MakeMove(*_board, _move_data, possible, _game_thread_close);
+	_clock.Stop();
+
 	if (_game_thread_close) {
 		return false;
 	}
 
+	if (_clock.IsFlagged(_current_player)) {
+		_result = _current_player == Piece::Color::WHITE ? Result::BLACK_WINS : Result::WHITE_WINS;
+		listener->OutOfTime();
+		return false;
+	}
+
 	Board premove = *_board;
 
-	std::cout << move << std::endl;
 	MakeMove(move);
-	std::cout << GetPsFEN() << std::endl;
 
-	window->GetEventHandler()->CallAfter([window, move, isHuman, premove]() {
-		window->FinishMove(premove, move, isHuman);
-	});
+	if (_statistics_sink) {
+		_statistics_sink->ReportMove(move, GetPsFEN());
+	}
+
+	listener->MoveMade(premove, move, player.IsHuman());
 
 	return true;
 }
 
+void Game::_InterruptPlayers() {
+	if (_player_white) {
+		_player_white->Interrupt();
+	}
+
+	if (_player_black) {
+		_player_black->Interrupt();
+	}
+}
+
+uint64_t Game::_Hash() const {
+	return Zobrist::Hash(*_board, _current_player, _move_data);
+}
+
+Game::_State Game::_GetState() const {
+	return { _move_data, _current_player, _fify_move_rule_count, _current_move };
+}
+
+void Game::_SetState(const _State& state) {
+	_move_data = state.move_data;
+	_current_player = state.player;
+	_fify_move_rule_count = state.fify_move_rule_count;
+	_current_move = state.move_number;
+}
+
+void Game::_ResetPlies() {
+	_plies.clear();
+	_changes.clear();
+	_ply = 0;
+
+	_history.Clear();
+	_history.Push(_Hash());
+
+	_hashes.assign(1, _history.GetLast());
+	_hash_offset = 0;
+}
+
+void Game::_Undo() {
+	const _Ply& ply = _plies[size_t(--_ply)];
+
+	for (size_t i = ply.first_change; i < ply.first_change + ply.change_count; i++) {
+		(*_board)[_changes[i].position] = _changes[i].before;
+	}
+
+	_SetState(ply.before);
+	_result = Result::NONE;
+}
+
+void Game::_Redo() {
+	const _Ply& ply = _plies[size_t(_ply++)];
+
+	for (size_t i = ply.first_change; i < ply.first_change + ply.change_count; i++) {
+		(*_board)[_changes[i].position] = _changes[i].after;
+	}
+
+	_SetState(ply.after);
+}
+
+void Game::_RestoreHistory() {
+	// the history is rebuilt from at most its capacity of hashes, no matter how
+	// long the game is.
+	size_t end = _hash_offset + size_t(_ply) + 1;
+	size_t start = _ply == 0 ? 0 : _plies[size_t(_ply) - 1].history_start;
+	start = std::max(start, end - std::min(end, PositionHistory::CAPACITY));
+
+	_history.Clear();
+	for (size_t i = start; i < end; i++) {
+		_history.Push(_hashes[i]);
+	}
+}
+
 }
@@ -7,17 +7,30 @@
 #include <thread>
 #include <memory>
 #include <atomic>
+#include <functional>
 
 #include "Player.h"
 #include "Board.h"
+#include "Clock.h"
+#include "GameListener.h"
 #include "GameMoveData.h"
+#include "PositionHistory.h"
+#include "PsFEN.h"
+#include "SearchStatistics.h"
 
 namespace ps {
 
-class Window;
-
 class Game {
 
+public:
+	enum class Result {
+		NONE, WHITE_WINS, BLACK_WINS, DRAW
+	};
+
+	enum class TurnResult {
+		MOVED, PARKED, OVER
+	};
+
 public:
 	Game();
 	~Game();
@@ -33,9 +46,62 @@ public:
 	 */
 	void SetPlayers(Player *white, Player *black);
 
-	bool SetState(const std::string& psFEN);
+	/**
+	 * Sets the sink that receives the moves of the game and the search
+	 * statistics of the players. The game does not take ownership of the
+	 * sink. By default, everything is written to the console.
+	 */
+	void SetStatisticsSink(StatisticsSink *sink);
+
+	/**
+	 * Sets the time control and resets the clocks of both players. A player
+	 * whose clock runs out loses the game.
+	 */
+	void SetTimeControl(const TimeControl& timeControl);
+	const Clock& GetClock() const;
+
+	/**
+	 * Sets the position from a PsFEN. If it cannot be parsed, the game is not
+	 * changed and the error describes where the PsFEN is invalid.
+	 */
+	bool SetState(std::string_view psFEN, PsFENError *error = nullptr);
+	void SetState(const Board& board, const GameMoveData& moveData, Piece::Color currentPlayer);
+
+	/**
+	 * Plays the game on a new thread, see Play().
+	 */
+	void StartThread(GameListener *listener);
+
+	/**
+	 * Plays the game on the calling thread until it is over, adjudicated or
+	 * stopped. The listener receives the moves and the end of the game.
+	 */
+	void Play(GameListener *listener);
+
+	/**
+	 * Plays a single turn of the game, for running many games on a few
+	 * threads. Returns OVER when the game is over, adjudicated or stopped.
+	 *
+	 * If wake is set and the player has to wait for its move, like a human
+	 * player, the turn is parked: it returns PARKED without holding the
+	 * thread, and wake is called from some other thread once the move is
+	 * there or the game is stopped. The next call resumes the turn. Without
+	 * wake, the turn waits for the move.
+	 */
+	TurnResult PlayTurn(GameListener *listener, const std::function<void()>& wake = nullptr);
+
+	/**
+	 * Stops the game without a result. Players that are thinking are asked to
+	 * return.
+	 */
+	void Stop();
 
-	void StartThread(Window *window);
+	/**
+	 * Ends the game with the given result. Intended to be called by the
+	 * listener, from the game thread.
+	 */
+	void Adjudicate(Result result);
+	Result GetResult() const;
 
 	const Board& GetBoard() const;
 
@@ -45,24 +111,141 @@ public:
 
 	void SwitchPlayerColor();
 
-	void MakeMove(const Move& move);
+	int GetFiftyMoveRuleCount() const;
+	int GetMoveNumber() const;
+
+	/**
+	 * Sets the fifty move rule count (in plies) and the move number, which
+	 * SetState resets.
+	 */
+	void SetMoveCounters(int fiftyMoveRuleCount, int moveNumber);
+
+	/**
+	 * Makes the move for the current player. If moves were undone, they are
+	 * discarded and the move starts a new variation. Returns the sub moves
+	 * that were performed, which cover every square that was changed.
+	 */
+	std::vector<SubMove> MakeMove(const Move& move);
+
+	/**
+	 * Takes back the last move, or makes the last move that was taken back
+	 * again. Both only touch the squares that were changed by the move, and
+	 * return false if there is no move to take back or make.
+	 */
+	bool Undo();
+	bool Redo();
+
+	/**
+	 * Goes to the position after the given number of plies since the last
+	 * SetState(), by undoing or redoing the moves in between. Returns false if
+	 * the ply is not between 0 and GetPlyCount().
+	 */
+	bool GoTo(int ply);
+
+	/**
+	 * The number of moves made since the last SetState(), and that number
+	 * including the moves that can be redone.
+	 */
+	int GetPly() const;
+	int GetPlyCount() const;
+
+	/**
+	 * Returns the move that was made at the given ply, from 0 to
+	 * GetPlyCount() - 1.
+	 */
+	const Move& GetMove(int ply) const;
+
+	/**
+	 * Returns how often the current position occurred since the last
+	 * irreversible move, including now. The game is drawn when a position
+	 * occurs for the third time.
+	 */
+	int GetRepetitionCount() const;
+	bool IsRepetition(int count = 3) const;
+
+	/**
+	 * The hashes of the positions since the last irreversible move, with the
+	 * current position last. Setting the history is meant for searches that
+	 * start from a position of a game and continue its history, so the last
+	 * hash must be that of the current position. The moves that were made
+	 * before are forgotten.
+	 */
+	const PositionHistory& GetHistory() const;
+	void SetHistory(const PositionHistory& history);
 
 	std::string GetPsFEN() const;
 
 private:
-	void _Loop(Window *window);
-	bool _MakeMove(const std::vector<Move>& possible, Player& player, Window *window, bool isHuman);
+	// the state besides the board that a move changes
+	struct _State {
+		GameMoveData move_data;
+		Piece::Color player;
+		int fify_move_rule_count;
+		int move_number;
+	};
+
+	struct _SquareChange {
+		BoardPosition position;
+		Piece before;
+		Piece after;
+	};
+
+	struct _Ply {
+		Move move;
+
+		// the squares that were changed are _changes[first_change] onwards
+		size_t first_change;
+		size_t change_count;
+
+		_State before;
+		_State after;
+
+		// the index in _hashes of the first position after the last
+		// irreversible move, up to and including this one.
+		size_t history_start;
+	};
+
+	bool _MakeMove(const std::vector<Move>& possible, Player& player, GameListener *listener);
+	void _InterruptPlayers();
+	uint64_t _Hash() const;
+
+	_State _GetState() const;
+	void _SetState(const _State& state);
+	void _ResetPlies();
+	void _Undo();
+	void _Redo();
+	void _RestoreHistory();
 
 	std::unique_ptr<Board> _board;
 
 	std::unique_ptr<Player> _player_white;
 	std::unique_ptr<Player> _player_black;
 	Piece::Color _current_player = Piece::Color::WHITE;
+	Result _result = Result::NONE;
+
+	StatisticsSink *_statistics_sink = &StreamStatisticsSink::Console();
+
+	Clock _clock;
 
 	GameMoveData _move_data;
 	int _fify_move_rule_count = 0;
 	int _current_move = 1;
 
+	PositionHistory _history;
+
+	// the moves since the last SetState(), of which the first _ply are made
+	std::vector<_Ply> _plies;
+	std::vector<_SquareChange> _changes;
+	int _ply = 0;
+
+	// the hashes of the positions since the start of the history; the
+	// position at ply 0 is _hashes[_hash_offset].
+	std::vector<uint64_t> _hashes;
+	size_t _hash_offset = 0;
+
+	// the current player was asked for a move in a parked turn
+	bool _move_requested = false;
+
 	std::atomic_bool _game_thread_close { false };
 	std::unique_ptr<std::thread> _game_thread;
 
@@ -0,0 +1,41 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef GAMELISTENER_H_
+#define GAMELISTENER_H_
+
+#include "Board.h"
+#include "Move.h"
+
+namespace ps {
+
+/**
+ * Receives the events of a game. All methods are called on the thread that
+ * plays the game, so implementations that touch a user interface have to hand
+ * the events over to their own thread.
+ */
+class GameListener {
+
+public:
+	virtual ~GameListener() = default;
+
+	/**
+	 * Called after a move was made. The premove is the board before the move.
+	 */
+	virtual void MoveMade(const Board& premove, const Move& move, bool fromHuman) = 0;
+
+	virtual void Mate() = 0;
+	virtual void Stalemate() = 0;
+	virtual void OutOfTime() = 0;
+
+	/**
+	 * Called when the game is drawn because a position occurred for the third
+	 * time.
+	 */
+	virtual void Repetition() = 0;
+
+};
+
+}
+
+#endif
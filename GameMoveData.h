@@ -14,6 +14,14 @@ struct GameMoveData {
 	bool can_white_castle_queen_side = true;
 	bool can_black_castle_king_side = true;
 	bool can_black_castle_queen_side = true;
+
+	bool operator==(const GameMoveData& data) const {
+		return en_passant_position == data.en_passant_position &&
+				can_white_castle_king_side == data.can_white_castle_king_side &&
+				can_white_castle_queen_side == data.can_white_castle_queen_side &&
+				can_black_castle_king_side == data.can_black_castle_king_side &&
+				can_black_castle_queen_side == data.can_black_castle_queen_side;
+	}
 };
 
 }
@@ -0,0 +1,294 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "GameRecord.h"
+
+#include <algorithm>
+
+namespace ps {
+
+static uint64_t readInteger(const uint8_t *data, int bytes) {
+	uint64_t value = 0;
+
+	for (int i = bytes - 1; i >= 0; i--) {
+		value = (value << 8) | data[i];
+	}
+
+	return value;
+}
+
+bool GameRecordWriter::Open(const std::string& file, bool append) {
+	Close();
+
+	if (append) {
+		// only append to files that have a header
+		std::ifstream existing(file, std::ios::binary);
+		char magic[4];
+
+		if (existing.read(magic, sizeof(magic)) && std::equal(magic, magic + 4, _MAGIC)) {
+			existing.close();
+			_out.open(file, std::ios::binary | std::ios::in | std::ios::out | std::ios::ate);
+			return bool(_out);
+		}
+	}
+
+	_out.open(file, std::ios::binary | std::ios::trunc);
+	_Write(_MAGIC, sizeof(_MAGIC));
+	_WriteInteger(_VERSION, 4);
+
+	return bool(_out);
+}
+
+void GameRecordWriter::Close() {
+	if (_out.is_open()) {
+		_out.close();
+	}
+
+	_in_game = false;
+}
+
+bool GameRecordWriter::IsOpen() const {
+	return _out.is_open();
+}
+
+bool GameRecordWriter::BeginGame(const std::string& startPsFEN, const std::string& white, const std::string& black) {
+	if (!_out || _in_game || startPsFEN.size() > UINT16_MAX) {
+		return false;
+	}
+
+	_game_start = _out.tellp();
+	_move_count = 0;
+	_in_game = true;
+
+	// the length and the result are written by EndGame
+	_WriteInteger(0, 4);
+	_WriteInteger(uint8_t(Game::Result::NONE), 1);
+
+	_WriteInteger(startPsFEN.size(), 2);
+	_Write(startPsFEN.data(), startPsFEN.size());
+
+	for (const std::string *name : { &white, &black }) {
+		size_t length = std::min<size_t>(name->size(), UINT8_MAX);
+		_WriteInteger(length, 1);
+		_Write(name->data(), length);
+	}
+
+	return bool(_out);
+}
+
+bool GameRecordWriter::AddMove(const Move& move) {
+	const auto& positions = move.GetPositions();
+
+	if (!_in_game || positions.empty() || positions.size() > UINT8_MAX) {
+		return false;
+	}
+
+	uint8_t data[UINT8_MAX + 1];
+	data[0] = uint8_t(positions.size());
+
+	for (size_t i = 0; i < positions.size(); i++) {
+		data[i + 1] = uint8_t(positions[i].GetRow() * 8 + positions[i].GetColumn());
+	}
+
+	_Write(data, positions.size() + 1);
+	_move_count++;
+
+	return bool(_out);
+}
+
+bool GameRecordWriter::EndGame(Game::Result result, uint64_t finalHash) {
+	if (!_in_game) {
+		return false;
+	}
+
+	_in_game = false;
+
+	_WriteInteger(0, 1);
+	_WriteInteger(_move_count, 4);
+	_WriteInteger(finalHash, 8);
+
+	std::streampos end = _out.tellp();
+	uint64_t length = uint64_t(end - _game_start) - 4;
+
+	_out.seekp(_game_start);
+	_WriteInteger(length, 4);
+	_WriteInteger(uint8_t(result), 1);
+	_out.seekp(end);
+
+	return bool(_out);
+}
+
+bool GameRecordWriter::Write(const GameRecord& record) {
+	if (!BeginGame(record.start_psfen, record.white, record.black)) {
+		return false;
+	}
+
+	for (const Move& move : record.moves) {
+		if (!AddMove(move)) {
+			return false;
+		}
+	}
+
+	return EndGame(record.result, record.final_hash);
+}
+
+void GameRecordWriter::_Write(const void *data, size_t size) {
+	_out.write(static_cast<const char *>(data), std::streamsize(size));
+}
+
+void GameRecordWriter::_WriteInteger(uint64_t value, int bytes) {
+	uint8_t data[8];
+
+	for (int i = 0; i < bytes; i++) {
+		data[i] = uint8_t(value >> (8 * i));
+	}
+
+	_Write(data, size_t(bytes));
+}
+
+bool GameRecordReader::Open(const std::string& file) {
+	Close();
+
+	_in.open(file, std::ios::binary);
+
+	char header[8];
+	if (!_in.read(header, sizeof(header)) || !std::equal(header, header + 4, GameRecordWriter::_MAGIC) ||
+			readInteger(reinterpret_cast<const uint8_t *>(header + 4), 4) != GameRecordWriter::_VERSION) {
+		_in.close();
+		return false;
+	}
+
+	return true;
+}
+
+void GameRecordReader::Close() {
+	if (_in.is_open()) {
+		_in.close();
+	}
+
+	_game_index = 0;
+	_at_end = false;
+}
+
+bool GameRecordReader::IsOpen() const {
+	return _in.is_open();
+}
+
+bool GameRecordReader::Read(GameRecord& record, bool withMoves) {
+	uint32_t length;
+	if (!_ReadLength(length)) {
+		return false;
+	}
+
+	_buffer.resize(length);
+	if (!_in.read(reinterpret_cast<char *>(_buffer.data()), length)) {
+		return false;
+	}
+
+	_game_index++;
+
+	const uint8_t *data = _buffer.data();
+	const uint8_t *end = data + length;
+
+	// the footer has a fixed size, so it can be read without the moves
+	constexpr size_t footerSize = 1 + 4 + 8;
+	if (length < 1 + 2 + 1 + 1 + footerSize) {
+		return false;
+	}
+
+	record.result = Game::Result(*data++);
+
+	size_t psFENLength = size_t(readInteger(data, 2));
+	data += 2;
+
+	if (size_t(end - data) < psFENLength + footerSize) {
+		return false;
+	}
+
+	record.start_psfen.assign(reinterpret_cast<const char *>(data), psFENLength);
+	data += psFENLength;
+
+	for (std::string *name : { &record.white, &record.black }) {
+		if (data >= end) {
+			return false;
+		}
+
+		size_t nameLength = *data++;
+		if (size_t(end - data) < nameLength + footerSize) {
+			return false;
+		}
+
+		name->assign(reinterpret_cast<const char *>(data), nameLength);
+		data += nameLength;
+	}
+
+	const uint8_t *footer = end - footerSize + 1;
+	size_t moveCount = size_t(readInteger(footer, 4));
+	record.final_hash = readInteger(footer + 4, 8);
+
+	record.moves.clear();
+
+	if (!withMoves) {
+		return true;
+	}
+
+	record.moves.reserve(moveCount);
+	const uint8_t *movesEnd = end - footerSize;
+
+	while (data < movesEnd && *data != 0) {
+		size_t count = *data++;
+
+		if (size_t(movesEnd - data) < count) {
+			return false;
+		}
+
+		// a position off the board would be read out of bounds later on
+		if (std::any_of(data, data + count, [](uint8_t position) { return position >= 64; })) {
+			return false;
+		}
+
+		Move move({ data[0] / 8, data[0] % 8 });
+		for (size_t i = 1; i < count; i++) {
+			move.AddPosition({ data[i] / 8, data[i] % 8 });
+		}
+
+		record.moves.push_back(std::move(move));
+		data += count;
+	}
+
+	return data == movesEnd && record.moves.size() == moveCount;
+}
+
+bool GameRecordReader::Skip() {
+	uint32_t length;
+	if (!_ReadLength(length)) {
+		return false;
+	}
+
+	_in.seekg(length, std::ios::cur);
+	_game_index++;
+
+	return bool(_in);
+}
+
+size_t GameRecordReader::GetGameIndex() const {
+	return _game_index;
+}
+
+bool GameRecordReader::IsAtEnd() const {
+	return _at_end;
+}
+
+bool GameRecordReader::_ReadLength(uint32_t& length) {
+	uint8_t data[4];
+
+	if (!_in.read(reinterpret_cast<char *>(data), sizeof(data))) {
+		_at_end = _in.eof() && _in.gcount() == 0;
+		return false;
+	}
+
+	length = uint32_t(readInteger(data, 4));
+	return true;
+}
+
+}
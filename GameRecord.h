@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef GAMERECORD_H_
+#define GAMERECORD_H_
+
+#include "Game.h"
+#include "Move.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ps {
+
+/**
+ * A played game: the start position, the players, the moves and the result.
+ * The hash of the final position allows to check a replay of the moves.
+ */
+struct GameRecord {
+	std::string start_psfen;
+	std::string white;
+	std::string black;
+	Game::Result result = Game::Result::NONE;
+	std::vector<Move> moves;
+	uint64_t final_hash = 0;
+};
+
+/**
+ * Appends games to a record file. The file starts with the magic "PSGR" and a
+ * version, followed by the games. Every game is prefixed with the length of
+ * its body, so readers can skip it:
+ *
+ *   u32 length
+ *   u8  result
+ *   u16 length, start PsFEN
+ *   u8  length, white player
+ *   u8  length, black player
+ *   moves: u8 position count, then one byte per position (row * 8 + column)
+ *   u8  0
+ *   u32 number of moves
+ *   u64 Zobrist hash of the final position
+ *
+ * All numbers are little endian. The moves are written as they are made, and
+ * the length and the result are filled in when the game ends.
+ */
+class GameRecordWriter {
+
+public:
+	bool Open(const std::string& file, bool append = false);
+	void Close();
+	bool IsOpen() const;
+
+	bool BeginGame(const std::string& startPsFEN, const std::string& white, const std::string& black);
+	bool AddMove(const Move& move);
+	bool EndGame(Game::Result result, uint64_t finalHash);
+
+	/**
+	 * Writes a complete game.
+	 */
+	bool Write(const GameRecord& record);
+
+private:
+	void _Write(const void *data, size_t size);
+	void _WriteInteger(uint64_t value, int bytes);
+
+	std::ofstream _out;
+	std::streampos _game_start;
+	uint32_t _move_count = 0;
+	bool _in_game = false;
+
+private:
+	static constexpr char _MAGIC[4] = { 'P', 'S', 'G', 'R' };
+	static constexpr uint32_t _VERSION = 1;
+
+	friend class GameRecordReader;
+
+};
+
+/**
+ * Reads the games of a record file one after another. Each game is read with
+ * a single read into a reused buffer, and games that are not needed are
+ * skipped by their length prefix without reading them.
+ */
+class GameRecordReader {
+
+public:
+	bool Open(const std::string& file);
+	void Close();
+	bool IsOpen() const;
+
+	/**
+	 * Reads the next game. Without moves, only the header and the footer are
+	 * decoded. Returns false at the end of the file or if the game is
+	 * malformed.
+	 */
+	bool Read(GameRecord& record, bool withMoves = true);
+
+	/**
+	 * Skips the next game. Returns false at the end of the file.
+	 */
+	bool Skip();
+
+	/**
+	 * Returns the index of the next game in the file.
+	 */
+	size_t GetGameIndex() const;
+
+	/**
+	 * Returns true if the file ended after the last complete game, so a false
+	 * Read() or Skip() was the end of the file and not a malformed game.
+	 */
+	bool IsAtEnd() const;
+
+private:
+	bool _ReadLength(uint32_t& length);
+
+	std::ifstream _in;
+	std::vector<uint8_t> _buffer;
+	size_t _game_index = 0;
+	bool _at_end = false;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "GameScheduler.h"
+
+#include <cassert>
+
+namespace ps {
+
+bool GameScheduler::_ReadyOrder::operator()(const _ReadyEntry& a, const _ReadyEntry& b) const {
+	// the priority queue puts the greatest entry first
+	if (a.key != b.key) {
+		return a.key > b.key;
+	}
+
+	return a.order > b.order;
+}
+
+GameScheduler::GameScheduler(size_t threadCount, Policy policy) :
+		_policy(policy), _thread_pool(threadCount) {
+
+	_timer = std::thread(&GameScheduler::_TimerMain, this);
+}
+
+GameScheduler::~GameScheduler() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		for (auto& entry : _tasks) {
+			entry.first->Stop();
+		}
+	}
+
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_closing = true;
+	}
+
+	_timer_condition.notify_one();
+	_timer.join();
+}
+
+void GameScheduler::Start(Game& game, GameListener *listener) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	auto& task = _tasks[&game];
+	assert(!task);
+
+	task = std::make_unique<_Task>();
+	task->game = &game;
+	task->listener = listener;
+	task->id = _next_id++;
+
+	_Queue(task.get());
+}
+
+void GameScheduler::Wait() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_finished.wait(lock, [this]() {
+		return _tasks.empty();
+	});
+}
+
+size_t GameScheduler::GetThreadCount() const {
+	return _thread_pool.GetThreadCount();
+}
+
+size_t GameScheduler::GetGameCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _tasks.size();
+}
+
+size_t GameScheduler::GetParkedCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _parked;
+}
+
+void GameScheduler::_Queue(_Task *task) {
+	// called with the lock held. Every queued game gets a run of its own, which
+	// takes whichever game is first at that time.
+	task->state = _Task::State::READY;
+
+	auto key = _policy == Policy::FAIR_SHARE ? task->turn_time : std::chrono::steady_clock::duration::zero();
+	_ready.push({ task, key, _order++ });
+
+	_thread_pool.Submit([this]() {
+		_RunNext();
+	});
+}
+
+void GameScheduler::_Wake(Game *game, uint64_t id) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// a move may arrive after the timer resumed the turn and the game ended
+	auto found = _tasks.find(game);
+	if (found == _tasks.end() || found->second->id != id) {
+		return;
+	}
+
+	_Task *task = found->second.get();
+
+	if (task->state == _Task::State::PARKED) {
+		_Unpark(task);
+	} else {
+		task->woken = true;
+	}
+}
+
+void GameScheduler::_Unpark(_Task *task) {
+	// called with the lock held
+	if (task->has_deadline) {
+		_deadlines.erase(task->deadline);
+		task->has_deadline = false;
+	}
+
+	_parked--;
+	_Queue(task);
+}
+
+void GameScheduler::_RunNext() {
+	_Task *task;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		task = _ready.top().task;
+		_ready.pop();
+
+		task->state = _Task::State::RUNNING;
+		task->woken = false;
+	}
+
+	// the wake is passed on to the workers, so the thread that delivers a move
+	// never waits for the scheduler.
+	auto start = std::chrono::steady_clock::now();
+	Game::TurnResult result = task->game->PlayTurn(task->listener, [this, game = task->game, id = task->id]() {
+		_thread_pool.Submit([this, game, id]() {
+			_Wake(game, id);
+		});
+	});
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	task->turn_time += std::chrono::steady_clock::now() - start;
+
+	switch (result) {
+		case Game::TurnResult::MOVED:
+			_Queue(task);
+			break;
+		case Game::TurnResult::PARKED:
+			if (task->woken) {
+				_Queue(task);
+			} else {
+				task->state = _Task::State::PARKED;
+				_parked++;
+
+				const Clock& clock = task->game->GetClock();
+				if (clock.IsEnabled()) {
+					auto deadline = std::chrono::steady_clock::now() + clock.GetRemaining(task->game->GetPlayerColor());
+					task->deadline = _deadlines.emplace(deadline, task);
+					task->has_deadline = true;
+					_timer_condition.notify_one();
+				}
+			}
+
+			break;
+		case Game::TurnResult::OVER:
+			_tasks.erase(task->game);
+			_finished.notify_all();
+			break;
+	}
+}
+
+void GameScheduler::_TimerMain() {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (!_closing) {
+		if (_deadlines.empty()) {
+			_timer_condition.wait(lock);
+		} else if (std::chrono::steady_clock::now() < _deadlines.begin()->first) {
+			_timer_condition.wait_until(lock, _deadlines.begin()->first);
+		} else {
+			// the turn is resumed to find out that its time ran out
+			_Unpark(_deadlines.begin()->second);
+		}
+	}
+}
+
+}
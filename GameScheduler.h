@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef GAMESCHEDULER_H_
+#define GAMESCHEDULER_H_
+
+#include "Game.h"
+#include "GameListener.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ps {
+
+/**
+ * Plays many games on a fixed set of threads, instead of a thread per game.
+ * Every game is a task that plays one turn at a time. A turn of a player that
+ * waits for its move, like a human, is parked without holding a thread, and
+ * the game is queued again when the move arrives. When the game has a clock,
+ * a timer thread queues it again once the clock of the parked player runs
+ * out, and the player has to end its turn without a move then.
+ *
+ * When there are more games ready than threads, the policy decides which game
+ * plays its turn first:
+ *  - ROUND_ROBIN: the game that has been ready the longest.
+ *  - FAIR_SHARE: the game that has spent the least time in its turns, so
+ *    engines in different games get about the same share of the threads.
+ *
+ * Engines should be created without threads of their own (see AiMcts), or
+ * they add threads beside those of the scheduler.
+ */
+class GameScheduler {
+
+public:
+	enum class Policy {
+		ROUND_ROBIN, FAIR_SHARE
+	};
+
+public:
+	GameScheduler(size_t threadCount = std::thread::hardware_concurrency(), Policy policy = Policy::FAIR_SHARE);
+
+	/**
+	 * Stops the games that are still being played, and waits for them.
+	 */
+	~GameScheduler();
+
+	GameScheduler(const GameScheduler&) = delete;
+	GameScheduler& operator=(const GameScheduler&) = delete;
+
+	/**
+	 * Starts playing the game, which must have its players. The game and the
+	 * listener have to stay alive until the game is over. Like with
+	 * Game::StartThread(), the listener is called from the threads of the
+	 * scheduler.
+	 */
+	void Start(Game& game, GameListener *listener);
+
+	/**
+	 * Waits until all games are over.
+	 */
+	void Wait();
+
+	size_t GetThreadCount() const;
+	size_t GetGameCount() const;
+	size_t GetParkedCount() const;
+
+private:
+	struct _Task;
+	using _Deadlines = std::multimap<std::chrono::steady_clock::time_point, _Task *>;
+
+	struct _Task {
+		Game *game;
+		GameListener *listener;
+
+		// tells the task apart from a later task of a game at the same address
+		uint64_t id;
+
+		enum class State { READY, RUNNING, PARKED } state = State::READY;
+
+		// woken up while the turn that parks it was still running
+		bool woken = false;
+
+		std::chrono::steady_clock::duration turn_time { 0 };
+
+		// when the clock of a parked turn runs out, if the game has a clock
+		bool has_deadline = false;
+		_Deadlines::iterator deadline;
+	};
+
+	struct _ReadyEntry {
+		_Task *task;
+		std::chrono::steady_clock::duration key;
+		uint64_t order;
+	};
+
+	struct _ReadyOrder {
+		bool operator()(const _ReadyEntry& a, const _ReadyEntry& b) const;
+	};
+
+	void _Queue(_Task *task);
+	void _Wake(Game *game, uint64_t id);
+	void _Unpark(_Task *task);
+	void _RunNext();
+	void _TimerMain();
+
+	Policy _policy;
+
+	mutable std::mutex _mutex;
+	std::condition_variable _finished;
+
+	std::unordered_map<Game *, std::unique_ptr<_Task>> _tasks;
+	std::priority_queue<_ReadyEntry, std::vector<_ReadyEntry>, _ReadyOrder> _ready;
+	uint64_t _order = 0;
+	uint64_t _next_id = 0;
+	size_t _parked = 0;
+
+	_Deadlines _deadlines;
+	std::condition_variable _timer_condition;
+	bool _closing = false;
+	std::thread _timer;
+
+	// declared last, so the workers are joined before the rest is destroyed
+	ThreadPool _thread_pool;
+
+};
+
+}
+
+#endif
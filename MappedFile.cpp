@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ps {
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept {
+	*this = std::move(file);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& file) noexcept {
+	if (this != &file) {
+		Close();
+
+		std::swap(_data, file._data);
+		std::swap(_size, file._size);
+
+#ifdef _WIN32
+		std::swap(_file_handle, file._file_handle);
+		std::swap(_mapping_handle, file._mapping_handle);
+#endif
+	}
+
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& file) {
+	Close();
+
+	HANDLE fileHandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	void *data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!data) {
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	_file_handle = fileHandle;
+	_mapping_handle = mappingHandle;
+	_data = static_cast<const uint8_t *>(data);
+	_size = size_t(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (_data) {
+		UnmapViewOfFile(_data);
+		CloseHandle(_mapping_handle);
+		CloseHandle(_file_handle);
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_file_handle = nullptr;
+	_mapping_handle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& file) {
+	Close();
+
+	int fd = open(file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	void *data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+	// the mapping stays valid after closing the descriptor
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	_data = static_cast<const uint8_t *>(data);
+	_size = size_t(status.st_size);
+	return true;
+}
+
+void MappedFile::Close() {
+	if (_data) {
+		munmap(const_cast<uint8_t *>(_data), _size);
+	}
+
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif
+
+bool MappedFile::IsOpen() const {
+	return _data != nullptr;
+}
+
+const uint8_t *MappedFile::GetData() const {
+	return _data;
+}
+
+size_t MappedFile::GetSize() const {
+	return _size;
+}
+
+}
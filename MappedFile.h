@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ps {
+
+/**
+ * A read-only memory mapping of a whole file. Pages are loaded by the
+ * operating system on first access and shared between processes that map the
+ * same file.
+ */
+class MappedFile {
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& file) noexcept;
+	MappedFile& operator=(MappedFile&& file) noexcept;
+
+	bool Open(const std::string& file);
+	void Close();
+
+	bool IsOpen() const;
+	const uint8_t *GetData() const;
+	size_t GetSize() const;
+
+private:
+	const uint8_t *_data = nullptr;
+	size_t _size = 0;
+
+#ifdef _WIN32
+	void *_file_handle = nullptr;
+	void *_mapping_handle = nullptr;
+#endif
+
+};
+
+}
+
+#endif
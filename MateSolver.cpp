@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "MateSolver.h"
+
+#include <algorithm>
+
+namespace ps {
+
+static uint32_t addSaturated(uint32_t a, uint32_t b) {
+	return a > UINT32_MAX - b ? UINT32_MAX : a + b;
+}
+
+MateSolver::MateSolver(size_t maxNodes) :
+		_max_nodes(maxNodes) {
+
+	// the table never grows beyond its capacity, so indices and references
+	// into it stay valid during a search.
+	_nodes.reserve(_max_nodes);
+}
+
+bool MateSolver::Solve(const std::string& psFEN, int moves, MateSolution& solution) {
+	Game game;
+	if (!game.SetState(psFEN)) {
+		return false;
+	}
+
+	Solve(game, moves, solution);
+	return true;
+}
+
+MateSolution::Result MateSolver::Solve(const Game& game, int moves, MateSolution& solution) {
+	_nodes.clear();
+
+	_Node root;
+	root.parent = _NONE;
+	root.moves_left = int16_t(moves);
+	root.is_or = true;
+	_nodes.push_back(std::move(root));
+
+	solution = MateSolution();
+
+	while (_nodes[0].proof != 0 && _nodes[0].disproof != 0) {
+		Game state = game;
+		uint32_t index = _SelectMostProving(state);
+
+		if (!_Expand(index, state)) {
+			break;
+		}
+
+		_UpdateAncestors(index);
+	}
+
+	if (_nodes[0].proof == 0) {
+		solution.result = MateSolution::Result::PROVEN;
+		_ExtractLine(solution.line);
+	} else if (_nodes[0].disproof == 0) {
+		solution.result = MateSolution::Result::DISPROVEN;
+	}
+
+	solution.nodes = _nodes.size();
+	return solution.result;
+}
+
+uint32_t MateSolver::_SelectMostProving(Game& state) const {
+	uint32_t index = 0;
+
+	while (_nodes[index].expanded && _nodes[index].child_count > 0) {
+		const _Node& node = _nodes[index];
+		uint32_t next = node.children;
+
+		// OR nodes follow the child with the smallest proof number, AND nodes
+		// the child with the smallest disproof number.
+		for (uint32_t i = node.children; i < node.children + node.child_count; i++) {
+			if (node.is_or ? _nodes[i].proof == node.proof : _nodes[i].disproof == node.disproof) {
+				next = i;
+				break;
+			}
+		}
+
+		state.MakeMove(_nodes[next].move);
+		index = next;
+	}
+
+	return index;
+}
+
+bool MateSolver::_Expand(uint32_t index, const Game& state) {
+	Piece::Color player = state.GetPlayerColor();
+	std::vector<Move> moves = state.GetBoard().GetAllPossibleMoves(player, state.GetMoveData());
+
+	// an AND node without moves left is a leaf, which is proven only if the
+	// defender has no moves. It adds no children, so it needs no room in the
+	// table.
+	if (!_nodes[index].is_or && _nodes[index].moves_left == 0) {
+		bool mate = moves.empty() && state.GetBoard().IsSako(player, state.GetMoveData());
+		_nodes[index].expanded = true;
+		_nodes[index].proof = mate ? 0 : _INFINITY;
+		_nodes[index].disproof = mate ? _INFINITY : 0;
+		return true;
+	}
+
+	// the move has to put the opponent in sako at OR nodes
+	if (_nodes[index].is_or) {
+		std::vector<Move> checks;
+
+		if (_nodes[index].moves_left > 0) {
+			for (Move& move : moves) {
+				Game next = state;
+				next.MakeMove(move);
+
+				if (next.GetBoard().IsSako(next.GetPlayerColor(), next.GetMoveData())) {
+					checks.push_back(std::move(move));
+				}
+			}
+		}
+
+		moves = std::move(checks);
+	}
+
+	if (_nodes.size() + moves.size() > _max_nodes) {
+		return false;
+	}
+
+	_Node& node = _nodes[index];
+	node.expanded = true;
+
+	if (moves.empty()) {
+		// the defender is mated or stalemated, or the attacker has no sako
+		// moves left.
+		bool mate = !node.is_or && state.GetBoard().IsSako(player, state.GetMoveData());
+		node.proof = mate ? 0 : _INFINITY;
+		node.disproof = mate ? _INFINITY : 0;
+		return true;
+	}
+
+	node.children = uint32_t(_nodes.size());
+	node.child_count = uint32_t(moves.size());
+
+	bool childOr = !node.is_or;
+	int16_t childMovesLeft = int16_t(node.is_or ? node.moves_left - 1 : node.moves_left);
+
+	for (Move& move : moves) {
+		_Node child;
+		child.move = std::move(move);
+		child.parent = index;
+		child.moves_left = childMovesLeft;
+		child.is_or = childOr;
+		_nodes.push_back(std::move(child));
+	}
+
+	_SetNumbers(_nodes[index]);
+	return true;
+}
+
+void MateSolver::_UpdateAncestors(uint32_t index) {
+	for (uint32_t i = _nodes[index].parent; i != _NONE; i = _nodes[i].parent) {
+		uint32_t proof = _nodes[i].proof;
+		uint32_t disproof = _nodes[i].disproof;
+
+		_SetNumbers(_nodes[i]);
+
+		if (_nodes[i].proof == proof && _nodes[i].disproof == disproof) {
+			break;
+		}
+	}
+}
+
+void MateSolver::_SetNumbers(_Node& node) const {
+	if (node.child_count == 0) {
+		return;
+	}
+
+	uint32_t minimum = _INFINITY;
+	uint32_t sum = 0;
+
+	for (uint32_t i = node.children; i < node.children + node.child_count; i++) {
+		const _Node& child = _nodes[i];
+
+		if (node.is_or) {
+			minimum = std::min(minimum, child.proof);
+			sum = addSaturated(sum, child.disproof);
+		} else {
+			minimum = std::min(minimum, child.disproof);
+			sum = addSaturated(sum, child.proof);
+		}
+	}
+
+	node.proof = node.is_or ? minimum : sum;
+	node.disproof = node.is_or ? sum : minimum;
+}
+
+void MateSolver::_ExtractLine(std::vector<Move>& line) const {
+	uint32_t index = 0;
+
+	while (_nodes[index].child_count > 0) {
+		const _Node& node = _nodes[index];
+		uint32_t next = _NONE;
+
+		// any proven child of an OR node mates; for AND nodes, follow the
+		// defence with the most replies, which is usually the longest.
+		for (uint32_t i = node.children; i < node.children + node.child_count; i++) {
+			if (_nodes[i].proof != 0) {
+				continue;
+			}
+
+			if (next == _NONE || (!node.is_or && _nodes[i].child_count > _nodes[next].child_count)) {
+				next = i;
+			}
+		}
+
+		if (next == _NONE) {
+			break;
+		}
+
+		line.push_back(_nodes[next].move);
+		index = next;
+	}
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef MATESOLVER_H_
+#define MATESOLVER_H_
+
+#include "Game.h"
+#include "Move.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ps {
+
+struct MateSolution {
+	enum class Result {
+		// the attacker mates within the given number of moves
+		PROVEN,
+
+		// there is no mate by sako moves within the given number of moves
+		DISPROVEN,
+
+		// the node table ran out before the search was decided
+		UNKNOWN
+	};
+
+	Result result = Result::UNKNOWN;
+
+	// a mating line, alternating attacker and defender moves.
+	std::vector<Move> line;
+
+	size_t nodes = 0;
+};
+
+/**
+ * Solves mate-in-N puzzles by proof-number search. The player to move is the
+ * attacker, and only the attacker's moves that put the defender in sako are
+ * searched, which keeps the tree narrow even when many chains are possible.
+ * The defender's moves are all searched.
+ *
+ * The nodes live in a table of fixed capacity that is allocated once, so the
+ * memory of a search is bounded no matter how deep the mate is.
+ */
+class MateSolver {
+
+public:
+	MateSolver(size_t maxNodes = _DEFAULT_NODES);
+
+	/**
+	 * Searches for a mate in at most the given number of attacker moves.
+	 * Returns false if the PsFEN could not be read.
+	 */
+	bool Solve(const std::string& psFEN, int moves, MateSolution& solution);
+	MateSolution::Result Solve(const Game& game, int moves, MateSolution& solution);
+
+private:
+	struct _Node {
+		Move move;
+		uint32_t parent;
+		uint32_t children = 0;
+		uint32_t child_count = 0;
+		uint32_t proof = 1;
+		uint32_t disproof = 1;
+
+		// the number of attacker moves that are left, including this node's
+		// own move for OR nodes.
+		int16_t moves_left;
+		bool is_or;
+		bool expanded = false;
+	};
+
+	uint32_t _SelectMostProving(Game& state) const;
+	bool _Expand(uint32_t index, const Game& state);
+	void _UpdateAncestors(uint32_t index);
+	void _SetNumbers(_Node& node) const;
+	void _ExtractLine(std::vector<Move>& line) const;
+
+	size_t _max_nodes;
+	std::vector<_Node> _nodes;
+
+private:
+	static constexpr size_t _DEFAULT_NODES = 1 << 20;
+	static constexpr uint32_t _INFINITY = UINT32_MAX;
+	static constexpr uint32_t _NONE = UINT32_MAX;
+
+};
+
+}
+
+#endif
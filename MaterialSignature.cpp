@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "MaterialSignature.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace ps {
+
+bool MaterialSignature::Parse(const std::string& name, MaterialSignature& signature) {
+	size_t separator = name.find('v');
+	if (separator == std::string::npos) {
+		return false;
+	}
+
+	MaterialSignature result;
+
+	for (size_t i = 0; i < name.size(); i++) {
+		if (i == separator) {
+			continue;
+		}
+
+		Piece::Type type = getTypeWhite(char(std::toupper(name[i])));
+		if (type == Piece::Type::NONE) {
+			return false;
+		}
+
+		(i < separator ? result._white : result._black).push_back(type);
+	}
+
+	if (std::count(result._white.begin(), result._white.end(), Piece::Type::KING) != 1 ||
+			std::count(result._black.begin(), result._black.end(), Piece::Type::KING) != 1 ||
+			result.GetPieceCount() > MAX_PIECES) {
+		return false;
+	}
+
+	result._Sort();
+	signature = std::move(result);
+	return true;
+}
+
+MaterialSignature MaterialSignature::Of(const Board& board) {
+	MaterialSignature signature;
+
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			const Piece& piece = board[{ r, c }];
+
+			if (piece.GetWhiteType() != Piece::Type::NONE) {
+				signature._white.push_back(piece.GetWhiteType());
+			}
+
+			if (piece.GetBlackType() != Piece::Type::NONE) {
+				signature._black.push_back(piece.GetBlackType());
+			}
+		}
+	}
+
+	signature._Sort();
+	return signature;
+}
+
+std::string MaterialSignature::GetName() const {
+	std::string name;
+
+	for (Piece::Type type : _white) {
+		name += getTypeCharWhite(type);
+	}
+
+	name += 'v';
+
+	for (Piece::Type type : _black) {
+		name += getTypeCharWhite(type);
+	}
+
+	return name;
+}
+
+size_t MaterialSignature::GetPieceCount() const {
+	return _white.size() + _black.size();
+}
+
+size_t MaterialSignature::GetPositionCount() const {
+	return size_t(2) << (6 * GetPieceCount());
+}
+
+const std::vector<Piece::Type>& MaterialSignature::GetWhitePieces() const {
+	return _white;
+}
+
+const std::vector<Piece::Type>& MaterialSignature::GetBlackPieces() const {
+	return _black;
+}
+
+std::vector<MaterialSignature> MaterialSignature::GetPromotions() const {
+	std::vector<MaterialSignature> promotions;
+
+	for (size_t i = 0; i < _white.size(); i++) {
+		if (_white[i] == Piece::Type::PAWN) {
+			MaterialSignature& promotion = promotions.emplace_back(*this);
+			promotion._white[i] = Piece::Type::QUEEN;
+			promotion._Sort();
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < _black.size(); i++) {
+		if (_black[i] == Piece::Type::PAWN) {
+			MaterialSignature& promotion = promotions.emplace_back(*this);
+			promotion._black[i] = Piece::Type::QUEEN;
+			promotion._Sort();
+			break;
+		}
+	}
+
+	return promotions;
+}
+
+size_t MaterialSignature::GetIndex(const Board& board, Piece::Color player) const {
+	// pieces of the same type are assigned in the order of their squares
+	std::vector<int> squares(GetPieceCount(), -1);
+
+	for (int square = 0; square < 64; square++) {
+		const Piece& piece = board[{ square / 8, square % 8 }];
+
+		for (size_t side = 0; side < 2; side++) {
+			Piece::Type type = side == 0 ? piece.GetWhiteType() : piece.GetBlackType();
+			if (type == Piece::Type::NONE) {
+				continue;
+			}
+
+			const auto& pieces = side == 0 ? _white : _black;
+			size_t offset = side == 0 ? 0 : _white.size();
+
+			for (size_t i = 0; i < pieces.size(); i++) {
+				if (pieces[i] == type && squares[offset + i] < 0) {
+					squares[offset + i] = square;
+					break;
+				}
+			}
+		}
+	}
+
+	size_t index = 0;
+	for (size_t i = squares.size(); i-- > 0;) {
+		index = (index << 6) | size_t(squares[i]);
+	}
+
+	return (index << 1) | (player == Piece::Color::BLACK);
+}
+
+bool MaterialSignature::SetupBoard(size_t index, Board& board, Piece::Color& player) const {
+	player = (index & 1) ? Piece::Color::BLACK : Piece::Color::WHITE;
+	index >>= 1;
+
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			board[{ r, c }] = Piece();
+		}
+	}
+
+	for (size_t i = 0; i < GetPieceCount(); i++, index >>= 6) {
+		bool white = i < _white.size();
+		Piece::Type type = white ? _white[i] : _black[i - _white.size()];
+		BoardPosition position { int(index & 63) / 8, int(index & 63) % 8 };
+
+		// pawns never stand on the first or the last row
+		if (type == Piece::Type::PAWN && (position.GetRow() == 0 || position.GetRow() == 7)) {
+			return false;
+		}
+
+		Piece& piece = board[position];
+		Piece::Type whiteType = white ? type : piece.GetWhiteType();
+		Piece::Type blackType = white ? piece.GetBlackType() : type;
+
+		// two pieces of the same player cannot share a square, and kings
+		// cannot be part of a union
+		if ((white ? piece.GetWhiteType() : piece.GetBlackType()) != Piece::Type::NONE) {
+			return false;
+		}
+
+		if (piece.GetColor() != Piece::Color::EMPTY &&
+				(type == Piece::Type::KING || piece.GetTypeOfColor(piece.GetColor()) == Piece::Type::KING)) {
+			return false;
+		}
+
+		piece = Piece(whiteType, blackType);
+	}
+
+	return true;
+}
+
+bool MaterialSignature::operator==(const MaterialSignature& signature) const {
+	return _white == signature._white && _black == signature._black;
+}
+
+void MaterialSignature::_Sort() {
+	// strongest pieces first, so the king always comes first
+	std::sort(_white.begin(), _white.end(), [](Piece::Type a, Piece::Type b) { return a > b; });
+	std::sort(_black.begin(), _black.end(), [](Piece::Type a, Piece::Type b) { return a > b; });
+}
+
+}
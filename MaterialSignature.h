@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef MATERIALSIGNATURE_H_
+#define MATERIALSIGNATURE_H_
+
+#include "Board.h"
+
+#include <string>
+#include <vector>
+
+namespace ps {
+
+/**
+ * The pieces of both players, regardless of their squares or unions. Since
+ * pieces never leave the board in paco sako, the signature of a game only
+ * changes by pawn promotions.
+ *
+ * A signature also defines the index of its positions in a tablebase: each
+ * piece takes six bits for its square, followed by one bit for the player to
+ * move.
+ */
+class MaterialSignature {
+
+public:
+	MaterialSignature() = default;
+
+	/**
+	 * Parses a signature like "KQvKP". Both players must have a king, and the
+	 * total number of pieces must not exceed MAX_PIECES.
+	 */
+	static bool Parse(const std::string& name, MaterialSignature& signature);
+	static MaterialSignature Of(const Board& board);
+
+	std::string GetName() const;
+	size_t GetPieceCount() const;
+	size_t GetPositionCount() const;
+
+	const std::vector<Piece::Type>& GetWhitePieces() const;
+	const std::vector<Piece::Type>& GetBlackPieces() const;
+
+	/**
+	 * Returns the signatures that a single pawn promotion leads to.
+	 */
+	std::vector<MaterialSignature> GetPromotions() const;
+
+	/**
+	 * Returns the index of the position in this signature. The board must have
+	 * exactly the pieces of this signature.
+	 */
+	size_t GetIndex(const Board& board, Piece::Color player) const;
+
+	/**
+	 * Sets up the board for the position with the given index. Returns false if
+	 * the index does not describe a valid placement of the pieces.
+	 */
+	bool SetupBoard(size_t index, Board& board, Piece::Color& player) const;
+
+	bool operator==(const MaterialSignature& signature) const;
+
+private:
+	void _Sort();
+
+	std::vector<Piece::Type> _white;
+	std::vector<Piece::Type> _black;
+
+public:
+	static constexpr size_t MAX_PIECES = 4;
+
+};
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "Move.h"
 
 //#include <cassert>
+#include <algorithm>
 
 #include "Board.h"
 
@@ -31,13 +32,58 @@ const std::vector<BoardPosition>& Move::GetPositions() const {
 	return _positions;
 }
 
+std::string Move::GetName() const {
+	std::string name;
+
+	for (const auto& position : _positions) {
+		name += position.GetName();
+	}
+
+	return name;
+}
+
 std::vector<SubMove> Move::GetSubMoves(const Board& board) const {
 	Board dummy = board;
 	return _Move(dummy);
 }
 
-void Move::PerformOn(Board &board) const {
-	_Move(board);
+std::vector<SubMove> Move::PerformOn(Board &board) const {
+	return _Move(board);
+}
+
+uint64_t Move::Pack() const {
+	if (_positions.size() > MAX_PACKED_POSITIONS) {
+		return 0;
+	}
+
+	uint64_t packed = _positions.size();
+
+	for (size_t i = 0; i < _positions.size(); i++) {
+		uint64_t square = _positions[i].GetRow() * 8 + _positions[i].GetColumn();
+		packed |= square << (4 + 6 * i);
+	}
+
+	return packed;
+}
+
+Move Move::Unpack(uint64_t packed) {
+	Move move;
+	size_t count = std::min<size_t>(packed & 0xF, MAX_PACKED_POSITIONS);
+
+	for (size_t i = 0; i < count; i++) {
+		int square = int((packed >> (4 + 6 * i)) & 0x3F);
+		move.AddPosition({ square / 8, square % 8 });
+	}
+
+	return move;
+}
+
+bool Move::operator==(const Move& move) const {
+	return _positions == move._positions;
+}
+
+bool Move::operator!=(const Move& move) const {
+	return _positions != move._positions;
 }
 
 std::vector<SubMove> Move::_Move(Board& board) const {
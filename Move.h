@@ -7,6 +7,7 @@
 #include "BoardPosition.h"
 #include "Piece.h"
 
+#include <cstdint>
 #include <vector>
 
 namespace ps {
@@ -37,9 +38,30 @@ public:
 
 	const std::vector<BoardPosition>& GetPositions() const;
 
+	/**
+	 * Returns the names of the positions without separators, like "e2e4" or
+	 * "d1d7c8d7" for a chain.
+	 */
+	std::string GetName() const;
+
 	std::vector<SubMove> GetSubMoves(const Board& board) const;
 
-	void PerformOn(Board& board) const;
+	/**
+	 * Performs the move on the board. Returns the sub moves that were made,
+	 * which together cover every square that was changed by the move.
+	 */
+	std::vector<SubMove> PerformOn(Board& board) const;
+
+	/**
+	 * Packs the move into 64 bits: the number of positions in the lowest four
+	 * bits, followed by six bits per position. Returns 0 if the move has more
+	 * than MAX_PACKED_POSITIONS positions.
+	 */
+	uint64_t Pack() const;
+	static Move Unpack(uint64_t packed);
+
+	bool operator==(const Move& move) const;
+	bool operator!=(const Move& move) const;
 
 	friend std::ostream& operator<<(std::ostream& out, const Move& move);
 
@@ -48,6 +70,9 @@ private:
 
 	std::vector<BoardPosition> _positions;
 
+public:
+	static constexpr size_t MAX_PACKED_POSITIONS = 10;
+
 };
 
 }
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "MoveHandoff.h"
+
+namespace ps {
+
+void MoveHandoff::Reset() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_delivered = false;
+	_wake = nullptr;
+}
+
+bool MoveHandoff::Wait(Move& move, const std::atomic_bool& stop, std::chrono::steady_clock::time_point deadline) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	// the turn is taken by this thread now, so nobody has to be woken anymore
+	_wake = nullptr;
+
+	// the stop flag is set before Interrupt() takes the lock, so it is either
+	// seen here or the notification arrives while waiting.
+	auto isReady = [this, &stop]() {
+		return _delivered || stop.load();
+	};
+
+	if (deadline == std::chrono::steady_clock::time_point::max()) {
+		_condition.wait(lock, isReady);
+	} else {
+		_condition.wait_until(lock, deadline, isReady);
+	}
+
+	if (stop.load() || !_delivered) {
+		return false;
+	}
+
+	move = std::move(_move);
+	_delivered = false;
+	return true;
+}
+
+bool MoveHandoff::WakeWhenReady(std::function<void()> wake) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (_delivered) {
+		return true;
+	}
+
+	_wake = std::move(wake);
+	return false;
+}
+
+void MoveHandoff::Deliver(const Move& move) {
+	std::function<void()> wake;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_move = move;
+		_delivered = true;
+		wake = std::move(_wake);
+		_wake = nullptr;
+	}
+
+	_condition.notify_one();
+
+	if (wake) {
+		wake();
+	}
+}
+
+void MoveHandoff::Interrupt() {
+	std::function<void()> wake;
+
+	// taking the lock makes sure that a waiter that has not seen the stop flag
+	// yet is waiting when it is notified.
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		wake = std::move(_wake);
+		_wake = nullptr;
+	}
+
+	_condition.notify_all();
+
+	if (wake) {
+		wake();
+	}
+}
+
+}
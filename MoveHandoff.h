@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef MOVEHANDOFF_H_
+#define MOVEHANDOFF_H_
+
+#include "Move.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace ps {
+
+/**
+ * Hands a move from one thread to a thread that waits for it. The waiting
+ * thread sleeps until the move is delivered or it is interrupted, and is
+ * woken exactly once for either.
+ */
+class MoveHandoff {
+
+public:
+	/**
+	 * Forgets a move that was delivered but not taken, before waiting for the
+	 * next one.
+	 */
+	void Reset();
+
+	/**
+	 * Waits until a move is delivered, until stop is set and Interrupt() is
+	 * called, or until the deadline. Returns false if no move was delivered.
+	 * A waker that was set by WakeWhenReady() is dropped.
+	 */
+	bool Wait(Move& move, const std::atomic_bool& stop,
+			std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+	/**
+	 * Instead of waiting, has wake called once when a move is delivered or
+	 * the handoff is interrupted. Returns true, without calling wake, if a
+	 * move was delivered already.
+	 */
+	bool WakeWhenReady(std::function<void()> wake);
+
+	void Deliver(const Move& move);
+
+	/**
+	 * Wakes the waiting thread to check its stop flag, which has to be set
+	 * before.
+	 */
+	void Interrupt();
+
+private:
+	std::mutex _mutex;
+	std::condition_variable _condition;
+
+	Move _move;
+	bool _delivered = false;
+
+	std::function<void()> _wake;
+
+};
+
+}
+
+#endif
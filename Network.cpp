@@ -0,0 +1,244 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Network.h"
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace ps {
+
+// The kernels below are selected at compile time. The accumulator rows are
+// multiples of 16 values, so the vector kernels never need a scalar tail.
+static_assert(Network::HIDDEN % 16 == 0, "hidden layer must fill whole vectors");
+
+static void addColumn(int16_t *accumulator, const int16_t *weights) {
+#if defined(__AVX2__)
+	for (int i = 0; i < Network::HIDDEN; i += 16) {
+		__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(accumulator + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+		_mm256_store_si256(reinterpret_cast<__m256i *>(accumulator + i), _mm256_add_epi16(a, w));
+	}
+#elif defined(__SSE4_1__)
+	for (int i = 0; i < Network::HIDDEN; i += 8) {
+		__m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(accumulator + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+		_mm_store_si128(reinterpret_cast<__m128i *>(accumulator + i), _mm_add_epi16(a, w));
+	}
+#else
+	for (int i = 0; i < Network::HIDDEN; i++) {
+		accumulator[i] = int16_t(accumulator[i] + weights[i]);
+	}
+#endif
+}
+
+static void subColumn(int16_t *accumulator, const int16_t *weights) {
+#if defined(__AVX2__)
+	for (int i = 0; i < Network::HIDDEN; i += 16) {
+		__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(accumulator + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+		_mm256_store_si256(reinterpret_cast<__m256i *>(accumulator + i), _mm256_sub_epi16(a, w));
+	}
+#elif defined(__SSE4_1__)
+	for (int i = 0; i < Network::HIDDEN; i += 8) {
+		__m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(accumulator + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+		_mm_store_si128(reinterpret_cast<__m128i *>(accumulator + i), _mm_sub_epi16(a, w));
+	}
+#else
+	for (int i = 0; i < Network::HIDDEN; i++) {
+		accumulator[i] = int16_t(accumulator[i] - weights[i]);
+	}
+#endif
+}
+
+/**
+ * The clipped ReLU of the accumulator, multiplied with the output weights.
+ */
+static int32_t dotClipped(const int16_t *accumulator, const int16_t *weights) {
+#if defined(__AVX2__)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i max = _mm256_set1_epi16(Network::QA);
+	__m256i sum = _mm256_setzero_si256();
+
+	for (int i = 0; i < Network::HIDDEN; i += 16) {
+		__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(accumulator + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+		a = _mm256_min_epi16(_mm256_max_epi16(a, zero), max);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, w));
+	}
+
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(half);
+#elif defined(__SSE4_1__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(Network::QA);
+	__m128i sum = _mm_setzero_si128();
+
+	for (int i = 0; i < Network::HIDDEN; i += 8) {
+		__m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(accumulator + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+		a = _mm_min_epi16(_mm_max_epi16(a, zero), max);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(a, w));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_extract_epi32(sum, 0);
+#else
+	int32_t sum = 0;
+
+	for (int i = 0; i < Network::HIDDEN; i++) {
+		int32_t a = accumulator[i];
+		a = a < 0 ? 0 : (a > Network::QA ? Network::QA : a);
+		sum += a * weights[i];
+	}
+
+	return sum;
+#endif
+}
+
+template<typename T>
+static bool readArray(std::ifstream& in, std::vector<T>& vec, size_t count) {
+	vec.resize(count);
+	in.read(reinterpret_cast<char *>(vec.data()), std::streamsize(count * sizeof(T)));
+	return bool(in);
+}
+
+Network::Network() :
+		_feature_weights(size_t(INPUTS) * HIDDEN),
+		_feature_biases(HIDDEN),
+		_output_weights(2 * HIDDEN) {}
+
+bool Network::Load(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	char magic[4];
+	uint32_t header[3];
+
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char *>(header), sizeof(header));
+
+	if (!in || !std::equal(magic, magic + 4, _MAGIC)) {
+		return false;
+	}
+
+	if (header[0] != _VERSION || header[1] != uint32_t(INPUTS) || header[2] != uint32_t(HIDDEN)) {
+		return false;
+	}
+
+	if (!readArray(in, _feature_weights, size_t(INPUTS) * HIDDEN) ||
+			!readArray(in, _feature_biases, HIDDEN) ||
+			!readArray(in, _output_weights, 2 * HIDDEN)) {
+		return false;
+	}
+
+	in.read(reinterpret_cast<char *>(&_output_bias), sizeof(_output_bias));
+	if (!in) {
+		return false;
+	}
+
+	_loaded = true;
+	return true;
+}
+
+bool Network::IsLoaded() const {
+	return _loaded;
+}
+
+void Network::Refresh(const Board& board, Accumulator& accumulator) const {
+	for (int perspective = 0; perspective < 2; perspective++) {
+		std::copy(_feature_biases.begin(), _feature_biases.end(), accumulator.values[perspective].begin());
+	}
+
+	accumulator.board = board;
+
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			_ApplyPiece({ r, c }, board[{ r, c }], accumulator, true);
+		}
+	}
+}
+
+void Network::MakeMove(Board& board, const Move& move, Accumulator& accumulator) const {
+	Update(board, move.PerformOn(board), accumulator);
+}
+
+void Network::Update(const Board& board, const std::vector<SubMove>& submoves, Accumulator& accumulator) const {
+	for (const SubMove& submove : submoves) {
+		_UpdateSquare(board, submove.start_position, accumulator);
+		_UpdateSquare(board, submove.end_position, accumulator);
+	}
+}
+
+int Network::Evaluate(const Accumulator& accumulator, Piece::Color color) const {
+	int us = color == Piece::Color::BLACK;
+	int them = 1 - us;
+
+	int64_t output = _output_bias;
+	output += dotClipped(accumulator.values[us].data(), _output_weights.data());
+	output += dotClipped(accumulator.values[them].data(), _output_weights.data() + HIDDEN);
+
+	return int(output * OUTPUT_SCALE / (QA * QB));
+}
+
+void Network::_UpdateSquare(const Board& board, const BoardPosition& position, Accumulator& accumulator) const {
+	Piece& old = accumulator.board[position];
+	const Piece& current = board[position];
+
+	if (old == current) {
+		return;
+	}
+
+	_ApplyPiece(position, old, accumulator, false);
+	_ApplyPiece(position, current, accumulator, true);
+	old = current;
+}
+
+void Network::_ApplyPiece(const BoardPosition& position, const Piece& piece, Accumulator& accumulator, bool add) const {
+	bool inUnion = piece.GetColor() == Piece::Color::UNION;
+
+	for (int perspective = 0; perspective < 2; perspective++) {
+		if (piece.GetWhiteType() != Piece::Type::NONE) {
+			_ApplyFeature(perspective, Piece::Color::WHITE, piece.GetWhiteType(), inUnion, position, accumulator, add);
+		}
+
+		if (piece.GetBlackType() != Piece::Type::NONE) {
+			_ApplyFeature(perspective, Piece::Color::BLACK, piece.GetBlackType(), inUnion, position, accumulator, add);
+		}
+	}
+}
+
+void Network::_ApplyFeature(int perspective, Piece::Color side, Piece::Type type, bool inUnion, const BoardPosition& position, Accumulator& accumulator, bool add) const {
+	int feature = _FeatureIndex(perspective, side, type, inUnion, position);
+	const int16_t *weights = _feature_weights.data() + size_t(feature) * HIDDEN;
+
+	if (add) {
+		addColumn(accumulator.values[perspective].data(), weights);
+	} else {
+		subColumn(accumulator.values[perspective].data(), weights);
+	}
+}
+
+int Network::_FeatureIndex(int perspective, Piece::Color side, Piece::Type type, bool inUnion, const BoardPosition& position) {
+	// features are relative to the perspective: own pieces first, and the
+	// board is mirrored for black so both perspectives share the weights.
+	int relativeSide = (side == Piece::Color::BLACK) != (perspective == 1);
+	int row = perspective == 0 ? position.GetRow() : 7 - position.GetRow();
+	int square = row * 8 + position.GetColumn();
+
+	return ((relativeSide * 2 + inUnion) * 6 + (int(type) - 1)) * 64 + square;
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef NETWORK_H_
+#define NETWORK_H_
+
+#include "Board.h"
+#include "Move.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ps {
+
+/**
+ * A small efficiently updatable neural network evaluation.
+ *
+ * The input features are piece type x square x side, seen from both players'
+ * perspectives, where the halves of a union are separate features from free
+ * pieces. The first layer is kept in an accumulator that is updated
+ * incrementally for the squares that are changed by a move, so that a full
+ * evaluation only costs the output layer.
+ */
+class Network {
+
+public:
+	// side (own or opponent) x free or union half x type x square
+	static constexpr int INPUTS = 2 * 2 * 6 * 64;
+	static constexpr int HIDDEN = 128;
+
+	// quantization of the hidden layer activations and the output weights.
+	static constexpr int QA = 255;
+	static constexpr int QB = 64;
+	static constexpr int OUTPUT_SCALE = 400;
+
+	struct Accumulator {
+		// the first layer, indexed by perspective (0 is white, 1 is black).
+		alignas(32) std::array<std::array<int16_t, HIDDEN>, 2> values;
+
+		// the board as last seen by the accumulator.
+		Board board;
+	};
+
+public:
+	Network();
+
+	/**
+	 * Loads the weights from a flat little-endian binary file. Returns false if
+	 * the file could not be read or does not match the network dimensions.
+	 */
+	bool Load(const std::string& file);
+	bool IsLoaded() const;
+
+	/**
+	 * Recalculates the accumulator from scratch.
+	 */
+	void Refresh(const Board& board, Accumulator& accumulator) const;
+
+	/**
+	 * Performs the move on the board and updates the accumulator for the
+	 * squares that were changed by the move.
+	 */
+	void MakeMove(Board& board, const Move& move, Accumulator& accumulator) const;
+
+	/**
+	 * Updates the accumulator after the sub moves were performed on the board
+	 * by the caller.
+	 */
+	void Update(const Board& board, const std::vector<SubMove>& submoves, Accumulator& accumulator) const;
+
+	/**
+	 * Returns the score of the position in centipawns, from the perspective of
+	 * the given player.
+	 */
+	int Evaluate(const Accumulator& accumulator, Piece::Color color) const;
+
+private:
+	void _UpdateSquare(const Board& board, const BoardPosition& position, Accumulator& accumulator) const;
+	void _ApplyPiece(const BoardPosition& position, const Piece& piece, Accumulator& accumulator, bool add) const;
+	void _ApplyFeature(int perspective, Piece::Color side, Piece::Type type, bool inUnion, const BoardPosition& position, Accumulator& accumulator, bool add) const;
+
+	static int _FeatureIndex(int perspective, Piece::Color side, Piece::Type type, bool inUnion, const BoardPosition& position);
+
+	bool _loaded = false;
+
+	std::vector<int16_t> _feature_weights;
+	std::vector<int16_t> _feature_biases;
+	std::vector<int16_t> _output_weights;
+	int32_t _output_bias = 0;
+
+private:
+	static constexpr char _MAGIC[4] = { 'P', 'S', 'N', 'N' };
+	static constexpr uint32_t _VERSION = 1;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "Zobrist.h"
+
+namespace ps {
+
+bool OpeningBook::Open(const std::string& file) {
+	_entries = nullptr;
+	_count = 0;
+
+	if (!_file.Open(file)) {
+		return false;
+	}
+
+	if (_file.GetSize() < sizeof(_Header)) {
+		_file.Close();
+		return false;
+	}
+
+	const _Header *header = reinterpret_cast<const _Header *>(_file.GetData());
+
+	if (!std::equal(header->magic, header->magic + 4, _MAGIC) || header->version != _VERSION ||
+			_file.GetSize() != sizeof(_Header) + header->count * sizeof(OpeningBookEntry)) {
+		_file.Close();
+		return false;
+	}
+
+	_entries = reinterpret_cast<const OpeningBookEntry *>(_file.GetData() + sizeof(_Header));
+	_count = size_t(header->count);
+	return true;
+}
+
+bool OpeningBook::IsOpen() const {
+	return _file.IsOpen();
+}
+
+size_t OpeningBook::GetSize() const {
+	return _count;
+}
+
+std::pair<const OpeningBookEntry *, const OpeningBookEntry *> OpeningBook::Find(uint64_t hash) const {
+	if (_count == 0) {
+		return { nullptr, nullptr };
+	}
+
+	// the hashes are uniformly distributed, so interpolating between the
+	// bounds gets close to the entry in a few steps. Each step keeps the
+	// invariant low <= first entry with the hash <= high.
+	size_t low = 0;
+	size_t high = _count - 1;
+
+	for (int step = 0; step < _INTERPOLATION_STEPS && low < high; step++) {
+		uint64_t lowHash = _entries[low].hash;
+		uint64_t highHash = _entries[high].hash;
+
+		if (hash <= lowHash || hash > highHash) {
+			break;
+		}
+
+		double fraction = double(hash - lowHash) / double(highHash - lowHash);
+		size_t probe = low + size_t(fraction * double(high - low));
+		probe = std::clamp(probe, low, high - 1);
+
+		if (_entries[probe].hash < hash) {
+			low = probe + 1;
+		} else {
+			high = probe;
+		}
+	}
+
+	const OpeningBookEntry *first = std::lower_bound(_entries + low, _entries + high + 1, hash,
+			[](const OpeningBookEntry& entry, uint64_t h) { return entry.hash < h; });
+
+	const OpeningBookEntry *last = first;
+	while (last != _entries + _count && last->hash == hash) {
+		last++;
+	}
+
+	return { first, last };
+}
+
+bool OpeningBook::Probe(const Board& board, Piece::Color player, const GameMoveData& moveData,
+		const std::vector<Move>& possible, std::mt19937_64& rng, Move& move) const {
+
+	auto [first, last] = Find(Zobrist::Hash(board, player, moveData));
+
+	std::vector<const Move *> candidates;
+	std::vector<uint32_t> weights;
+
+	for (const OpeningBookEntry *entry = first; entry != last; entry++) {
+		Move bookMove = Move::Unpack(entry->move);
+
+		// guard against hash collisions by only playing possible moves
+		auto iter = std::find(possible.begin(), possible.end(), bookMove);
+		if (iter != possible.end() && entry->weight > 0) {
+			candidates.push_back(&*iter);
+			weights.push_back(entry->weight);
+		}
+	}
+
+	if (candidates.empty()) {
+		return false;
+	}
+
+	std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+	move = *candidates[dist(rng)];
+	return true;
+}
+
+bool OpeningBook::Write(const std::string& file, std::vector<OpeningBookEntry> entries) {
+	std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+		return a.hash < b.hash || (a.hash == b.hash && a.move < b.move);
+	});
+
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		return false;
+	}
+
+	_Header header {};
+	std::copy(_MAGIC, _MAGIC + 4, header.magic);
+	header.version = _VERSION;
+	header.count = entries.size();
+
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char *>(entries.data()), std::streamsize(entries.size() * sizeof(OpeningBookEntry)));
+
+	return bool(out);
+}
+
+}
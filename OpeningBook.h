@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef OPENINGBOOK_H_
+#define OPENINGBOOK_H_
+
+#include "Board.h"
+#include "GameMoveData.h"
+#include "MappedFile.h"
+#include "Move.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ps {
+
+struct OpeningBookEntry {
+	// the Zobrist hash of the position
+	uint64_t hash;
+
+	// the move, as packed by Move::Pack()
+	uint64_t move;
+
+	// the relative probability of playing the move
+	uint32_t weight;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(OpeningBookEntry) == 24, "opening book entries must be packed");
+
+/**
+ * An opening book, stored as a header followed by entries sorted by position
+ * hash. The file is memory mapped, so opening it costs nothing beyond checking
+ * the header, and lookups read the entries in place.
+ */
+class OpeningBook {
+
+public:
+	bool Open(const std::string& file);
+	bool IsOpen() const;
+	size_t GetSize() const;
+
+	/**
+	 * Returns the range of entries of the position with the given hash.
+	 */
+	std::pair<const OpeningBookEntry *, const OpeningBookEntry *> Find(uint64_t hash) const;
+
+	/**
+	 * Picks a book move for the position, at random by weight among the book
+	 * moves that are possible. Returns false if there is none.
+	 */
+	bool Probe(const Board& board, Piece::Color player, const GameMoveData& moveData,
+			const std::vector<Move>& possible, std::mt19937_64& rng, Move& move) const;
+
+	/**
+	 * Sorts the entries and writes them as a book file.
+	 */
+	static bool Write(const std::string& file, std::vector<OpeningBookEntry> entries);
+
+private:
+	MappedFile _file;
+	const OpeningBookEntry *_entries = nullptr;
+	size_t _count = 0;
+
+private:
+	struct _Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t count;
+	};
+
+	static constexpr char _MAGIC[4] = { 'P', 'S', 'O', 'B' };
+	static constexpr uint32_t _VERSION = 1;
+
+	// the number of interpolation steps before falling back to bisection.
+	static constexpr int _INTERPOLATION_STEPS = 4;
+
+};
+
+}
+
+#endif
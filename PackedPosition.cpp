@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "PackedPosition.h"
+
+namespace ps {
+
+static constexpr int PIECE_NIBBLES = 32;
+static constexpr uint8_t UNION_CODE = 12;
+static constexpr uint8_t NO_EN_PASSANT = 255;
+
+static void setNibble(PackedPosition& packed, int index, uint8_t value) {
+	uint8_t& byte = packed.data[8 + index / 2];
+	byte |= uint8_t(value << (4 * (index % 2)));
+}
+
+static uint8_t getNibble(const PackedPosition& packed, int index) {
+	return (packed.data[8 + index / 2] >> (4 * (index % 2))) & 0xF;
+}
+
+static void writeInteger(PackedPosition& packed, int offset, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		packed.data[offset + i] = uint8_t(value >> (8 * i));
+	}
+}
+
+static uint64_t readInteger(const PackedPosition& packed, int offset, int bytes) {
+	uint64_t value = 0;
+
+	for (int i = bytes - 1; i >= 0; i--) {
+		value = (value << 8) | packed.data[offset + i];
+	}
+
+	return value;
+}
+
+bool PackedPosition::Pack(const Game& game, PackedPosition& packed) {
+	return Pack(game.GetBoard(), game.GetPlayerColor(), game.GetMoveData(),
+			game.GetFiftyMoveRuleCount(), game.GetMoveNumber(), packed);
+}
+
+bool PackedPosition::Pack(const Board& board, Piece::Color player, const GameMoveData& moveData,
+		int fiftyMoveRuleCount, int moveNumber, PackedPosition& packed) {
+
+	if (fiftyMoveRuleCount < 0 || fiftyMoveRuleCount > UINT16_MAX || moveNumber < 0 || moveNumber > UINT16_MAX) {
+		return false;
+	}
+
+	packed = PackedPosition();
+
+	uint64_t occupancy = 0;
+	int nibble = 0;
+
+	for (int square = 0; square < 64; square++) {
+		const Piece& piece = board[{ square / 8, square % 8 }];
+		int white = int(piece.GetWhiteType());
+		int black = int(piece.GetBlackType());
+
+		if (piece.GetColor() == Piece::Color::EMPTY) {
+			continue;
+		}
+
+		occupancy |= uint64_t(1) << square;
+
+		if (piece.GetColor() == Piece::Color::UNION) {
+			if (nibble + 2 > PIECE_NIBBLES) {
+				return false;
+			}
+
+			int combination = (white - 1) * 6 + (black - 1);
+			setNibble(packed, nibble++, uint8_t(UNION_CODE + combination / 16));
+			setNibble(packed, nibble++, uint8_t(combination % 16));
+		} else {
+			if (nibble + 1 > PIECE_NIBBLES) {
+				return false;
+			}
+
+			setNibble(packed, nibble++, uint8_t(white != 0 ? white - 1 : 6 + black - 1));
+		}
+	}
+
+	writeInteger(packed, 0, occupancy, 8);
+
+	packed.data[24] = uint8_t((player == Piece::Color::BLACK) |
+			moveData.can_white_castle_king_side << 1 |
+			moveData.can_white_castle_queen_side << 2 |
+			moveData.can_black_castle_king_side << 3 |
+			moveData.can_black_castle_queen_side << 4);
+
+	const BoardPosition& ep = moveData.en_passant_position;
+	packed.data[25] = ep.IsValid() ? uint8_t(ep.GetRow() * 8 + ep.GetColumn()) : NO_EN_PASSANT;
+
+	writeInteger(packed, 26, uint64_t(fiftyMoveRuleCount), 2);
+	writeInteger(packed, 28, uint64_t(moveNumber), 2);
+
+	return true;
+}
+
+bool PackedPosition::Unpack(Game& game) const {
+	Board board;
+	Piece::Color player;
+	GameMoveData moveData;
+	int fiftyMoveRuleCount, moveNumber;
+
+	if (!Unpack(board, player, moveData, fiftyMoveRuleCount, moveNumber)) {
+		return false;
+	}
+
+	game.SetState(board, moveData, player);
+	game.SetMoveCounters(fiftyMoveRuleCount, moveNumber);
+	return true;
+}
+
+bool PackedPosition::Unpack(Board& board, Piece::Color& player, GameMoveData& moveData,
+		int& fiftyMoveRuleCount, int& moveNumber) const {
+
+	uint64_t occupancy = readInteger(*this, 0, 8);
+	int nibble = 0;
+
+	for (int square = 0; square < 64; square++) {
+		Piece& piece = board[{ square / 8, square % 8 }];
+
+		if (!(occupancy & (uint64_t(1) << square))) {
+			piece = Piece();
+			continue;
+		}
+
+		if (nibble >= PIECE_NIBBLES) {
+			return false;
+		}
+
+		uint8_t code = getNibble(*this, nibble++);
+
+		if (code < 6) {
+			piece = Piece(Piece::Type(code + 1), Piece::Type::NONE);
+		} else if (code < UNION_CODE) {
+			piece = Piece(Piece::Type::NONE, Piece::Type(code - 6 + 1));
+		} else {
+			if (nibble >= PIECE_NIBBLES) {
+				return false;
+			}
+
+			int combination = (code - UNION_CODE) * 16 + getNibble(*this, nibble++);
+			if (combination >= 36) {
+				return false;
+			}
+
+			piece = Piece(Piece::Type(combination / 6 + 1), Piece::Type(combination % 6 + 1));
+		}
+	}
+
+	uint8_t flags = data[24];
+	player = flags & 1 ? Piece::Color::BLACK : Piece::Color::WHITE;
+	moveData.can_white_castle_king_side = flags & 2;
+	moveData.can_white_castle_queen_side = flags & 4;
+	moveData.can_black_castle_king_side = flags & 8;
+	moveData.can_black_castle_queen_side = flags & 16;
+
+	uint8_t ep = data[25];
+	if (ep != NO_EN_PASSANT && ep >= 64) {
+		return false;
+	}
+
+	moveData.en_passant_position = ep == NO_EN_PASSANT ? BoardPosition { -1, -1 } : BoardPosition { ep / 8, ep % 8 };
+
+	fiftyMoveRuleCount = int(readInteger(*this, 26, 2));
+	moveNumber = int(readInteger(*this, 28, 2));
+
+	return true;
+}
+
+uint64_t PackedPosition::GetPositionHash() const {
+	uint64_t words[3];
+	std::memcpy(words, data.data(), sizeof(words));
+
+	uint64_t result = readInteger(*this, 24, 2);
+	for (uint64_t word : words) {
+		result = (result ^ word) * 0x9e3779b97f4a7c15ull;
+		result ^= result >> 29;
+	}
+
+	return result;
+}
+
+bool PackedPosition::IsSamePosition(const PackedPosition& position) const {
+	return std::memcmp(data.data(), position.data.data(), POSITION_SIZE) == 0;
+}
+
+bool PackedPosition::operator==(const PackedPosition& position) const {
+	return data == position.data;
+}
+
+bool PackedPosition::operator!=(const PackedPosition& position) const {
+	return data != position.data;
+}
+
+}
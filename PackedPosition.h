@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef PACKEDPOSITION_H_
+#define PACKEDPOSITION_H_
+
+#include "Board.h"
+#include "Game.h"
+#include "GameMoveData.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace ps {
+
+/**
+ * A position in 32 bytes, for storing many positions densely:
+ *
+ *   0-7    occupancy, one bit per square (row * 8 + column)
+ *   8-23   the pieces of the occupied squares in square order, one nibble
+ *          each, low nibble first: 0-5 are the white pawn, rook, knight,
+ *          bishop, queen and king, 6-11 the black pieces. A union takes two
+ *          nibbles, 12 + combination / 16 and combination % 16, where the
+ *          combination is (white type - 1) * 6 + (black type - 1).
+ *   24     the player to move (bit 0) and the castling rights KQkq (bits 1-4)
+ *   25     the en passant position (row * 8 + column), or 255
+ *   26-27  the fifty move rule count
+ *   28-29  the move number
+ *   30-31  reserved, zero
+ *
+ * Every piece half takes a nibble, so the 32 pieces of a game always fit.
+ */
+struct PackedPosition {
+	// the number of bytes that describe the position itself, without the
+	// move counters.
+	static constexpr size_t POSITION_SIZE = 26;
+
+	std::array<uint8_t, 32> data {};
+
+	/**
+	 * Returns false if the position does not fit, which only happens for
+	 * boards with more than 32 piece halves or counters above 65535.
+	 */
+	static bool Pack(const Game& game, PackedPosition& packed);
+	static bool Pack(const Board& board, Piece::Color player, const GameMoveData& moveData,
+			int fiftyMoveRuleCount, int moveNumber, PackedPosition& packed);
+
+	/**
+	 * Returns false if the data does not describe a position.
+	 */
+	bool Unpack(Game& game) const;
+	bool Unpack(Board& board, Piece::Color& player, GameMoveData& moveData,
+			int& fiftyMoveRuleCount, int& moveNumber) const;
+
+	/**
+	 * The hash and the comparison of the position without the move counters,
+	 * so that the same position reached at different moves is equal.
+	 */
+	uint64_t GetPositionHash() const;
+	bool IsSamePosition(const PackedPosition& position) const;
+
+	bool operator==(const PackedPosition& position) const;
+	bool operator!=(const PackedPosition& position) const;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "packed positions must be 32 bytes");
+
+}
+
+namespace std {
+
+template<>
+struct hash<ps::PackedPosition> {
+	size_t operator()(const ps::PackedPosition& position) const {
+		uint64_t words[4];
+		std::memcpy(words, position.data.data(), sizeof(words));
+
+		uint64_t result = words[0];
+		for (int i = 1; i < 4; i++) {
+			result = (result ^ words[i]) * 0x9e3779b97f4a7c15ull;
+		}
+
+		return size_t(result ^ (result >> 32));
+	}
+};
+
+}
+
+#endif
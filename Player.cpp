@@ -10,4 +10,30 @@ Player::Player(Piece::Color playerColor) :
 
 Player::~Player() {}
 
+bool Player::RequestMove(const Board& board, const GameMoveData& moveData, const std::function<void()>& wake) {
+	return true;
+}
+
+void Player::StartPondering(const Board& board, const GameMoveData& moveData) {}
+
+void Player::StopPondering() {}
+
+void Player::Interrupt() {}
+
+bool Player::IsHuman() const {
+	return false;
+}
+
+void Player::SetStatisticsSink(StatisticsSink *sink) {
+	_statistics_sink = sink;
+}
+
+void Player::SetClock(const Clock *clock) {
+	_clock = clock;
+}
+
+void Player::SetPositionHistory(const PositionHistory *history) {
+	_position_history = history;
+}
+
 }
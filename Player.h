@@ -5,10 +5,14 @@
 #define PLAYER_H_
 
 #include "Board.h"
+#include "Clock.h"
 #include "GameMoveData.h"
 #include "Move.h"
+#include "PositionHistory.h"
+#include "SearchStatistics.h"
 
 #include <atomic>
+#include <functional>
 
 namespace ps {
 
@@ -23,8 +27,62 @@ public:
 	 */
 	virtual Move MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) = 0;
 
+	/**
+	 * Will be called by a host game that runs on a shared thread, before
+	 * MakeMove(). Returns true if MakeMove() can be called right away.
+	 * Otherwise, the player calls wake once, from any thread, when MakeMove()
+	 * would no longer wait or when it was interrupted. Players that compute
+	 * their move themselves are always ready.
+	 */
+	virtual bool RequestMove(const Board& board, const GameMoveData& moveData, const std::function<void()>& wake);
+
+	/**
+	 * Will be called by the host game on the game loop thread when the
+	 * opponent starts thinking about their move in the given position. The
+	 * player may use the time to search in the background until
+	 * StopPondering() is called, which will happen before the next call to
+	 * MakeMove().
+	 */
+	virtual void StartPondering(const Board& board, const GameMoveData& moveData);
+	virtual void StopPondering();
+
+	/**
+	 * Will be called by the host game, from any thread, after it set the stop
+	 * flag of MakeMove(). Players that wait for something else than the stop
+	 * flag have to be woken up here.
+	 */
+	virtual void Interrupt();
+
+	/**
+	 * Returns whether the moves are made by a human through the user
+	 * interface.
+	 */
+	virtual bool IsHuman() const;
+
+	/**
+	 * Sets the sink that search players report their statistics to, or
+	 * nullptr to not report them.
+	 */
+	void SetStatisticsSink(StatisticsSink *sink);
+
+	/**
+	 * Sets the clock of the host game, or nullptr if the game is played
+	 * without one. The clock is only accessed from the game loop thread.
+	 */
+	void SetClock(const Clock *clock);
+
+	/**
+	 * Sets the position history of the host game, or nullptr if there is
+	 * none. Its last position is the one passed to MakeMove() and
+	 * StartPondering(), and it is only accessed from the game loop thread.
+	 */
+	void SetPositionHistory(const PositionHistory *history);
+
 protected:
 	const Piece::Color _player_color;
+	StatisticsSink *_statistics_sink = nullptr;
+	const Clock *_clock = nullptr;
+	const PositionHistory *_position_history = nullptr;
 
 };
 
@@ -3,8 +3,6 @@
  */
 #include "PlayerHuman.h"
 
-#include <chrono>
-
 #include "Window.h"
 
 namespace ps {
@@ -13,18 +11,34 @@ PlayerHuman::PlayerHuman(Piece::Color playerColor, Window *window) :
 		Player(playerColor), _window(window) {}
 
 Move PlayerHuman::MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) {
-	std::future<Move> move = _window->StartMove(_player_color);
-	std::future_status status;
+	MoveHandoff& handoff = _requested ? *_requested : _window->StartMove(_player_color);
+	_requested = nullptr;
 
-	do {
-		status = move.wait_for(std::chrono::milliseconds(10));
-	} while (status == std::future_status::timeout && !stop);
+	// the turn ends when the clock runs out, with or without a move
+	auto deadline = std::chrono::steady_clock::time_point::max();
+	if (_clock) {
+		deadline = std::chrono::steady_clock::now() + _clock->GetRemaining(_player_color);
+	}
 
-	if (stop || status != std::future_status::ready) {
+	Move move;
+	if (!handoff.Wait(move, stop, deadline)) {
 		return Move();
-	} else {
-		return move.get();
 	}
+
+	return move;
+}
+
+bool PlayerHuman::RequestMove(const Board& board, const GameMoveData& moveData, const std::function<void()>& wake) {
+	_requested = &_window->StartMove(_player_color);
+	return _requested->WakeWhenReady(wake);
+}
+
+void PlayerHuman::Interrupt() {
+	_window->InterruptMove();
+}
+
+bool PlayerHuman::IsHuman() const {
+	return true;
 }
 
 }
@@ -4,6 +4,7 @@
 #ifndef PLAYERHUMAN_H_
 #define PLAYERHUMAN_H_
 
+#include "MoveHandoff.h"
 #include "Player.h"
 
 namespace ps {
@@ -16,10 +17,17 @@ public:
 	PlayerHuman(Piece::Color playerColor, Window *window);
 
 	Move MakeMove(const Board& board, const GameMoveData& moveData, const std::vector<Move>& possible, std::atomic_bool& stop) override;
+	bool RequestMove(const Board& board, const GameMoveData& moveData, const std::function<void()>& wake) override;
+	void Interrupt() override;
+
+	bool IsHuman() const override;
 
 private:
 	Window *_window;
 
+	// the handoff of a move that was requested but not made yet
+	MoveHandoff *_requested = nullptr;
+
 };
 
 }
@@ -0,0 +1,328 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "PositionDeduplicator.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <random>
+
+namespace ps {
+
+/**
+ * Reads the outcomes of a sorted run through a buffer of its own.
+ */
+class DeduplicationRunReader {
+
+public:
+	DeduplicationRunReader(const std::string& file, size_t bufferSize) :
+			_buffer(std::max(bufferSize, sizeof(PositionOutcomes))) {
+
+		_in.rdbuf()->pubsetbuf(_buffer.data(), std::streamsize(_buffer.size()));
+		_in.open(file, std::ios::binary);
+	}
+
+	bool IsOpen() const {
+		return _in.is_open();
+	}
+
+	bool Next() {
+		if (!_in.read(reinterpret_cast<char *>(&current), sizeof(current))) {
+			return false;
+		}
+
+		key = current.position.GetPositionHash();
+		return true;
+	}
+
+	bool IsAtEnd() {
+		return _in.eof() && _in.gcount() == 0;
+	}
+
+	PositionOutcomes current {};
+	uint64_t key = 0;
+
+private:
+	std::vector<char> _buffer;
+	std::ifstream _in;
+
+};
+
+PositionDeduplicator::PositionDeduplicator(const DeduplicationSettings& settings) :
+		_settings(settings) {
+
+	_settings.threads = std::max<size_t>(_settings.threads, 1);
+
+	if (_settings.temp_directory.empty()) {
+		std::error_code error;
+		_settings.temp_directory = std::filesystem::temp_directory_path(error).string();
+	}
+
+	std::random_device random;
+	_temp_prefix = "psdedup-" + std::to_string(random()) + "-";
+}
+
+bool PositionDeduplicator::Run(const std::vector<std::string>& inputs, const std::string& output) {
+	_summary = DeduplicationSummary();
+
+	std::vector<std::string> runs;
+	bool success = _CreateRuns(inputs, runs);
+	_summary.runs = runs.size();
+
+	// every pass merges as many runs as there are read buffers in the budget,
+	// up to the limit of open files, until the last pass writes the output.
+	size_t fanIn = std::clamp<size_t>(_settings.memory_budget / _MIN_MERGE_BUFFER - 1, 2, _MAX_FAN_IN);
+
+	while (success && runs.size() > fanIn) {
+		std::vector<std::string> merged;
+
+		// after a failed merge, the remaining groups are only removed
+		for (size_t i = 0; i < runs.size(); i += fanIn) {
+			std::vector<std::string> group(runs.begin() + i, runs.begin() + std::min(runs.size(), i + fanIn));
+
+			if (success) {
+				merged.push_back(_GetTempFile());
+				success = _Merge(group, merged.back());
+			}
+
+			for (const std::string& run : group) {
+				std::error_code error;
+				std::filesystem::remove(run, error);
+			}
+		}
+
+		runs = std::move(merged);
+		_summary.merge_passes++;
+	}
+
+	if (success) {
+		success = _Merge(runs, output);
+		_summary.merge_passes++;
+	}
+
+	for (const std::string& run : runs) {
+		std::error_code error;
+		std::filesystem::remove(run, error);
+	}
+
+	if (success) {
+		std::error_code error;
+		_summary.positions = std::filesystem::file_size(output, error) / sizeof(PositionOutcomes);
+	}
+
+	return success;
+}
+
+const DeduplicationSummary& PositionDeduplicator::GetSummary() const {
+	return _summary;
+}
+
+bool PositionDeduplicator::_CreateRuns(const std::vector<std::string>& inputs, std::vector<std::string>& runs) {
+	ThreadPool pool(_settings.threads);
+
+	// a run is filled while the other threads sort, so the budget is split
+	// over one run per thread and the one being read.
+	size_t runSize = std::max<size_t>(_READ_BLOCK, _settings.memory_budget / ((_settings.threads + 1) * sizeof(_Entry)));
+
+	std::deque<std::future<bool>> pending;
+	bool success = true;
+
+	auto submit = [&](std::vector<_Entry> entries) {
+		runs.push_back(_GetTempFile());
+
+		auto shared = std::make_shared<std::vector<_Entry>>(std::move(entries));
+		pending.push_back(pool.Submit([shared, file = runs.back()]() {
+			return _SortRun(*shared, file);
+		}));
+
+		while (pending.size() >= _settings.threads) {
+			success = pending.front().get() && success;
+			pending.pop_front();
+		}
+	};
+
+	std::vector<_Entry> entries;
+	entries.reserve(runSize);
+
+	std::vector<PositionSample> block(_READ_BLOCK);
+
+	for (const std::string& input : inputs) {
+		std::ifstream in(input, std::ios::binary);
+		if (!in) {
+			success = false;
+			break;
+		}
+
+		while (in) {
+			in.read(reinterpret_cast<char *>(block.data()), std::streamsize(block.size() * sizeof(PositionSample)));
+			size_t count = size_t(in.gcount()) / sizeof(PositionSample);
+
+			for (size_t i = 0; i < count; i++) {
+				const PositionSample& sample = block[i];
+
+				_Entry entry;
+				entry.key = sample.position.GetPositionHash();
+				entry.outcomes.position = sample.position;
+				entry.outcomes.count = 1;
+				entry.outcomes.white_wins = sample.result > 0;
+				entry.outcomes.black_wins = sample.result < 0;
+				entry.outcomes.draws = sample.result == 0;
+				entry.outcomes.score_sum = sample.score;
+				entries.push_back(entry);
+
+				if (entries.size() == runSize) {
+					submit(std::move(entries));
+					entries = std::vector<_Entry>();
+					entries.reserve(runSize);
+				}
+			}
+
+			_summary.samples += count;
+		}
+	}
+
+	if (!entries.empty()) {
+		submit(std::move(entries));
+	}
+
+	while (!pending.empty()) {
+		success = pending.front().get() && success;
+		pending.pop_front();
+	}
+
+	return success;
+}
+
+bool PositionDeduplicator::_Merge(const std::vector<std::string>& runs, const std::string& output) const {
+	size_t bufferSize = _settings.memory_budget / (runs.size() + 1);
+
+	std::vector<std::unique_ptr<DeduplicationRunReader>> readers;
+	for (const std::string& run : runs) {
+		readers.push_back(std::make_unique<DeduplicationRunReader>(run, bufferSize));
+
+		if (!readers.back()->IsOpen()) {
+			return false;
+		}
+	}
+
+	std::vector<char> outBuffer(std::max(bufferSize, sizeof(PositionOutcomes)));
+	std::ofstream out;
+	out.rdbuf()->pubsetbuf(outBuffer.data(), std::streamsize(outBuffer.size()));
+	out.open(output, std::ios::binary | std::ios::trunc);
+
+	if (!out) {
+		return false;
+	}
+
+	// the heap holds the reader indices, ordered by their current outcome
+	auto after = [&readers](size_t a, size_t b) {
+		const DeduplicationRunReader& x = *readers[a];
+		const DeduplicationRunReader& y = *readers[b];
+
+		if (x.key != y.key) {
+			return x.key > y.key;
+		}
+
+		return std::memcmp(x.current.position.data.data(), y.current.position.data.data(), PackedPosition::POSITION_SIZE) > 0;
+	};
+
+	std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+
+	for (size_t i = 0; i < readers.size(); i++) {
+		if (readers[i]->Next()) {
+			heap.push(i);
+		}
+	}
+
+	bool hasTotal = false;
+	PositionOutcomes total {};
+
+	while (!heap.empty()) {
+		size_t index = heap.top();
+		heap.pop();
+
+		DeduplicationRunReader& reader = *readers[index];
+
+		if (hasTotal && total.position.IsSamePosition(reader.current.position)) {
+			_Add(total, reader.current);
+		} else {
+			if (hasTotal) {
+				out.write(reinterpret_cast<const char *>(&total), sizeof(total));
+			}
+
+			total = reader.current;
+			hasTotal = true;
+		}
+
+		if (reader.Next()) {
+			heap.push(index);
+		} else if (!reader.IsAtEnd()) {
+			return false;
+		}
+	}
+
+	if (hasTotal) {
+		out.write(reinterpret_cast<const char *>(&total), sizeof(total));
+	}
+
+	out.flush();
+	return bool(out);
+}
+
+std::string PositionDeduplicator::_GetTempFile() {
+	std::filesystem::path path(_settings.temp_directory);
+	path /= _temp_prefix + std::to_string(_temp_count++) + ".run";
+	return path.string();
+}
+
+bool PositionDeduplicator::_SortRun(std::vector<_Entry>& entries, const std::string& file) {
+	std::sort(entries.begin(), entries.end(), _IsBefore);
+
+	std::ofstream out(file, std::ios::binary | std::ios::trunc);
+	if (!out) {
+		return false;
+	}
+
+	// aggregate the equal positions of the run in place, then write them
+	size_t unique = 0;
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (unique > 0 && entries[unique - 1].key == entries[i].key &&
+				entries[unique - 1].outcomes.position.IsSamePosition(entries[i].outcomes.position)) {
+			_Add(entries[unique - 1].outcomes, entries[i].outcomes);
+		} else {
+			entries[unique++] = entries[i];
+		}
+	}
+
+	for (size_t i = 0; i < unique; i++) {
+		out.write(reinterpret_cast<const char *>(&entries[i].outcomes), sizeof(PositionOutcomes));
+	}
+
+	return bool(out);
+}
+
+bool PositionDeduplicator::_IsBefore(const _Entry& a, const _Entry& b) {
+	if (a.key != b.key) {
+		return a.key < b.key;
+	}
+
+	return std::memcmp(a.outcomes.position.data.data(), b.outcomes.position.data.data(), PackedPosition::POSITION_SIZE) < 0;
+}
+
+void PositionDeduplicator::_Add(PositionOutcomes& total, const PositionOutcomes& outcomes) {
+	total.count += outcomes.count;
+	total.white_wins += outcomes.white_wins;
+	total.black_wins += outcomes.black_wins;
+	total.draws += outcomes.draws;
+	total.score_sum += outcomes.score_sum;
+}
+
+}
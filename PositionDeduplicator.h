@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef POSITIONDEDUPLICATOR_H_
+#define POSITIONDEDUPLICATOR_H_
+
+#include "PositionSample.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ps {
+
+struct DeduplicationSettings {
+	size_t threads = std::thread::hardware_concurrency();
+
+	// the memory for the sort runs and the merge buffers, in bytes.
+	size_t memory_budget = size_t(256) << 20;
+
+	// where the sorted runs are kept. Empty for the system temporary directory.
+	std::string temp_directory;
+};
+
+struct DeduplicationSummary {
+	uint64_t samples = 0;
+	uint64_t positions = 0;
+	size_t runs = 0;
+	size_t merge_passes = 0;
+};
+
+/**
+ * Deduplicates files of position samples into one file of position outcomes,
+ * sorted by position hash. Positions are equal when they are equal without
+ * the move counters.
+ *
+ * The samples are read in runs that fit the memory budget. Each run is sorted
+ * and aggregated on a thread pool and written to a temporary file, while the
+ * next run is read. The runs are then merged k-way, with as many runs per pass
+ * as the budget has room for read buffers, until a single output remains.
+ */
+class PositionDeduplicator {
+
+public:
+	PositionDeduplicator(const DeduplicationSettings& settings);
+
+	bool Run(const std::vector<std::string>& inputs, const std::string& output);
+
+	const DeduplicationSummary& GetSummary() const;
+
+private:
+	struct _Entry {
+		uint64_t key;
+		PositionOutcomes outcomes;
+	};
+
+	bool _CreateRuns(const std::vector<std::string>& inputs, std::vector<std::string>& runs);
+	bool _Merge(const std::vector<std::string>& runs, const std::string& output) const;
+	std::string _GetTempFile();
+
+	static bool _SortRun(std::vector<_Entry>& entries, const std::string& file);
+	static bool _IsBefore(const _Entry& a, const _Entry& b);
+	static void _Add(PositionOutcomes& total, const PositionOutcomes& outcomes);
+
+	DeduplicationSettings _settings;
+	DeduplicationSummary _summary;
+
+	std::string _temp_prefix;
+	size_t _temp_count = 0;
+
+private:
+	static constexpr size_t _MIN_MERGE_BUFFER = size_t(64) << 10;
+
+	// the most runs that are open at once, well below the usual limit of 1024
+	// open files.
+	static constexpr size_t _MAX_FAN_IN = 256;
+	static constexpr size_t _READ_BLOCK = 4096;
+
+};
+
+}
+
+#endif
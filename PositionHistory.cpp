@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "PositionHistory.h"
+
+#include <cassert>
+
+namespace ps {
+
+void PositionHistory::Clear() {
+	// only the buckets of the hashes in the ring have to be reset, which is
+	// paid for by the pushes that filled them.
+	for (size_t i = 0; i < _size; i++) {
+		_bucket_counts[_Bucket(_hashes[(_first + i) % CAPACITY])] = 0;
+	}
+
+	_first = 0;
+	_size = 0;
+}
+
+void PositionHistory::Push(uint64_t hash) {
+	if (_size == CAPACITY) {
+		_bucket_counts[_Bucket(_hashes[_first])]--;
+		_first = (_first + 1) % CAPACITY;
+		_size--;
+	}
+
+	_hashes[(_first + _size) % CAPACITY] = hash;
+	_size++;
+	_bucket_counts[_Bucket(hash)]++;
+}
+
+int PositionHistory::GetLastCount() const {
+	uint64_t hash = GetLast();
+
+	if (_bucket_counts[_Bucket(hash)] == 1) {
+		return 1;
+	}
+
+	int count = 0;
+
+	for (size_t i = 0; i < _size; i++) {
+		count += _hashes[(_first + i) % CAPACITY] == hash;
+	}
+
+	return count;
+}
+
+uint64_t PositionHistory::GetLast() const {
+	assert(_size > 0);
+	return _hashes[(_first + _size - 1) % CAPACITY];
+}
+
+uint64_t PositionHistory::GetHash(size_t index) const {
+	assert(index < _size);
+	return _hashes[(_first + index) % CAPACITY];
+}
+
+bool PositionHistory::IsEmpty() const {
+	return _size == 0;
+}
+
+size_t PositionHistory::GetSize() const {
+	return _size;
+}
+
+size_t PositionHistory::_Bucket(uint64_t hash) {
+	return size_t(hash >> 32) % (4 * CAPACITY);
+}
+
+}
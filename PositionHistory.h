@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef POSITIONHISTORY_H_
+#define POSITIONHISTORY_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ps {
+
+/**
+ * The hashes of the positions since the last irreversible move, for detecting
+ * repetitions. The hashes are kept in a ring of fixed size, and beside the
+ * ring, the number of hashes is counted per bucket of hash values. The last
+ * position is in its own bucket, so if that bucket holds a single hash, the
+ * position has not occurred before. The ring is only scanned for the exact
+ * count when another hash shares the bucket.
+ */
+class PositionHistory {
+
+public:
+	// repetitions further apart than this many plies are not detected.
+	static constexpr size_t CAPACITY = 128;
+
+public:
+	void Clear();
+
+	/**
+	 * Adds the hash of the position after a reversible move. If the ring is
+	 * full, the oldest position is dropped.
+	 */
+	void Push(uint64_t hash);
+
+	/**
+	 * Returns how often the last position occurs in the history, which must
+	 * not be empty.
+	 */
+	int GetLastCount() const;
+
+	/**
+	 * Returns the hash of the last position, which must exist.
+	 */
+	uint64_t GetLast() const;
+
+	/**
+	 * Returns the hash at the index, counted from the oldest position.
+	 */
+	uint64_t GetHash(size_t index) const;
+
+	bool IsEmpty() const;
+	size_t GetSize() const;
+
+private:
+	static size_t _Bucket(uint64_t hash);
+
+	std::array<uint64_t, CAPACITY> _hashes;
+	size_t _first = 0;
+	size_t _size = 0;
+
+	std::array<uint8_t, 4 * CAPACITY> _bucket_counts {};
+
+};
+
+}
+
+#endif
@@ -0,0 +1,286 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "PositionIndex.h"
+
+#include "ThreadPool.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+
+namespace ps {
+
+bool PositionIndex::Open(const std::string& file) {
+	_block_hashes = nullptr;
+	_entries = nullptr;
+	_block_count = 0;
+	_count = 0;
+
+	if (!_file.Open(file)) {
+		return false;
+	}
+
+	if (_file.GetSize() < sizeof(_Header)) {
+		_file.Close();
+		return false;
+	}
+
+	const _Header *header = reinterpret_cast<const _Header *>(_file.GetData());
+
+	if (!std::equal(header->magic, header->magic + 4, _MAGIC) || header->version != _VERSION ||
+			header->block_count != (header->count + _BLOCK_SIZE - 1) / _BLOCK_SIZE ||
+			header->entries_offset < sizeof(_Header) + header->block_count * sizeof(uint64_t) ||
+			_file.GetSize() != header->entries_offset + header->count * sizeof(PositionIndexEntry)) {
+		_file.Close();
+		return false;
+	}
+
+	_block_hashes = reinterpret_cast<const uint64_t *>(_file.GetData() + sizeof(_Header));
+	_entries = reinterpret_cast<const PositionIndexEntry *>(_file.GetData() + header->entries_offset);
+	_block_count = size_t(header->block_count);
+	_count = size_t(header->count);
+	return true;
+}
+
+bool PositionIndex::IsOpen() const {
+	return _file.IsOpen();
+}
+
+size_t PositionIndex::GetSize() const {
+	return _count;
+}
+
+std::pair<const PositionIndexEntry *, const PositionIndexEntry *> PositionIndex::Find(uint64_t hash) const {
+	if (_count == 0) {
+		return { nullptr, nullptr };
+	}
+
+	// the first entry with the hash is in the last block that starts with a
+	// smaller hash, or it is the first entry of the block after it.
+	size_t block = size_t(std::lower_bound(_block_hashes, _block_hashes + _block_count, hash) - _block_hashes);
+	block = block > 0 ? block - 1 : 0;
+
+	const PositionIndexEntry *begin = _entries + block * _BLOCK_SIZE;
+	const PositionIndexEntry *end = _entries + std::min(_count, (block + 1) * _BLOCK_SIZE + 1);
+
+	const PositionIndexEntry *first = std::lower_bound(begin, end, hash,
+			[](const PositionIndexEntry& entry, uint64_t h) { return entry.hash < h; });
+
+	const PositionIndexEntry *last = first;
+	while (last != _entries + _count && last->hash == hash) {
+		last++;
+	}
+
+	return { first, last };
+}
+
+PositionStatistics PositionIndex::GetStatistics(uint64_t hash) const {
+	PositionStatistics statistics;
+	auto [first, last] = Find(hash);
+
+	for (const PositionIndexEntry *entry = first; entry != last; entry++) {
+		statistics.games += entry->games;
+		statistics.white_wins += entry->white_wins;
+		statistics.black_wins += entry->black_wins;
+		statistics.draws += entry->draws;
+	}
+
+	return statistics;
+}
+
+bool PositionIndex::Write(const std::string& file, std::vector<PositionIndexEntry> entries) {
+	std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+		return a.hash < b.hash || (a.hash == b.hash && a.move < b.move);
+	});
+
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		return false;
+	}
+
+	std::vector<uint64_t> blockHashes;
+	for (size_t i = 0; i < entries.size(); i += _BLOCK_SIZE) {
+		blockHashes.push_back(entries[i].hash);
+	}
+
+	// the entries start on a page boundary, so every block is one page.
+	size_t offset = sizeof(_Header) + blockHashes.size() * sizeof(uint64_t);
+	size_t entriesOffset = (offset + _PAGE_SIZE - 1) / _PAGE_SIZE * _PAGE_SIZE;
+
+	_Header header {};
+	std::copy(_MAGIC, _MAGIC + 4, header.magic);
+	header.version = _VERSION;
+	header.count = entries.size();
+	header.block_count = blockHashes.size();
+	header.entries_offset = entriesOffset;
+
+	std::vector<char> padding(entriesOffset - offset, 0);
+
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char *>(blockHashes.data()), std::streamsize(blockHashes.size() * sizeof(uint64_t)));
+	out.write(padding.data(), std::streamsize(padding.size()));
+	out.write(reinterpret_cast<const char *>(entries.data()), std::streamsize(entries.size() * sizeof(PositionIndexEntry)));
+
+	return bool(out);
+}
+
+PositionIndexer::PositionIndexer(size_t threadCount) :
+		_thread_count(std::max<size_t>(threadCount, 1)) {}
+
+bool PositionIndexer::Add(const GameRecord& record) {
+	_Statistics statistics;
+
+	bool valid = _Replay(record, statistics);
+
+	_Merge(statistics, valid, !valid);
+	return valid;
+}
+
+bool PositionIndexer::AddArchive(const std::string& file) {
+	GameRecordReader reader;
+	if (!reader.Open(file)) {
+		return false;
+	}
+
+	ThreadPool pool(_thread_count);
+	std::vector<std::future<void>> pending;
+
+	auto submit = [this, &pool, &pending](std::vector<GameRecord> batch) {
+		pending.push_back(pool.Submit([this, batch = std::move(batch)]() {
+			_Statistics statistics;
+			size_t games = 0;
+
+			for (const GameRecord& record : batch) {
+				games += _Replay(record, statistics);
+			}
+
+			_Merge(statistics, games, batch.size() - games);
+		}));
+
+		// keep a bounded number of batches in memory
+		if (pending.size() >= 2 * _thread_count) {
+			pending.front().get();
+			pending.erase(pending.begin());
+		}
+	};
+
+	std::vector<GameRecord> batch;
+	GameRecord record;
+
+	while (reader.Read(record)) {
+		batch.push_back(std::move(record));
+
+		if (batch.size() == _BATCH_SIZE) {
+			submit(std::move(batch));
+			batch.clear();
+		}
+	}
+
+	if (!batch.empty()) {
+		submit(std::move(batch));
+	}
+
+	for (auto& future : pending) {
+		future.get();
+	}
+
+	// a malformed game stops the reader before the end of the file
+	return reader.IsAtEnd();
+}
+
+size_t PositionIndexer::GetGameCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _game_count;
+}
+
+size_t PositionIndexer::GetSkippedCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _skipped_count;
+}
+
+size_t PositionIndexer::GetSize() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _statistics.size();
+}
+
+bool PositionIndexer::Write(const std::string& file) const {
+	std::vector<PositionIndexEntry> entries;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		entries.reserve(_statistics.size());
+
+		for (const auto& [key, entry] : _statistics) {
+			entries.push_back(entry);
+		}
+	}
+
+	return PositionIndex::Write(file, std::move(entries));
+}
+
+bool PositionIndexer::_Replay(const GameRecord& record, _Statistics& statistics) {
+	Game game;
+	if (!game.SetState(record.start_psfen)) {
+		return false;
+	}
+
+	// the archive may be corrupt, so every move is checked before it is made,
+	// and nothing is counted until the whole game is known to be legal. A
+	// position is only counted the first time the game reaches it.
+	std::vector<_Key> keys;
+	std::unordered_set<uint64_t> seen;
+
+	auto visit = [&keys, &seen, &game](uint64_t move) {
+		uint64_t hash = Zobrist::Hash(game.GetBoard(), game.GetPlayerColor(), game.GetMoveData());
+
+		if (seen.insert(hash).second) {
+			keys.push_back({ hash, move });
+		}
+	};
+
+	for (const Move& move : record.moves) {
+		auto possible = game.GetBoard().GetAllPossibleMoves(game.GetPlayerColor(), game.GetMoveData());
+
+		if (std::find(possible.begin(), possible.end(), move) == possible.end()) {
+			return false;
+		}
+
+		visit(move.Pack());
+		game.MakeMove(move);
+	}
+
+	visit(PositionIndex::NO_MOVE);
+
+	for (const _Key& key : keys) {
+		PositionIndexEntry& entry = statistics[key];
+		entry.hash = key.hash;
+		entry.move = key.move;
+		entry.games++;
+		entry.white_wins += record.result == Game::Result::WHITE_WINS;
+		entry.black_wins += record.result == Game::Result::BLACK_WINS;
+		entry.draws += record.result == Game::Result::DRAW;
+	}
+
+	return true;
+}
+
+void PositionIndexer::_Merge(const _Statistics& statistics, size_t games, size_t skipped) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (const auto& [key, entry] : statistics) {
+		PositionIndexEntry& total = _statistics[key];
+		total.hash = entry.hash;
+		total.move = entry.move;
+		total.games += entry.games;
+		total.white_wins += entry.white_wins;
+		total.black_wins += entry.black_wins;
+		total.draws += entry.draws;
+	}
+
+	_game_count += games;
+	_skipped_count += skipped;
+}
+
+}
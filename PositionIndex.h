@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef POSITIONINDEX_H_
+#define POSITIONINDEX_H_
+
+#include "Game.h"
+#include "GameRecord.h"
+#include "MappedFile.h"
+#include "Move.h"
+
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ps {
+
+struct PositionIndexEntry {
+	// the Zobrist hash of the position
+	uint64_t hash;
+
+	// the move played in the position, as packed by Move::Pack(), or
+	// PositionIndex::NO_MOVE for the games that ended in the position or
+	// continued with a move that cannot be packed.
+	uint64_t move;
+
+	// the number of games, and their results
+	uint32_t games;
+	uint32_t white_wins;
+	uint32_t black_wins;
+	uint32_t draws;
+};
+
+static_assert(sizeof(PositionIndexEntry) == 32, "position index entries must be packed");
+
+/**
+ * The totals of all entries of a position.
+ */
+struct PositionStatistics {
+	uint64_t games = 0;
+	uint64_t white_wins = 0;
+	uint64_t black_wins = 0;
+	uint64_t draws = 0;
+};
+
+/**
+ * An index of the positions of a game archive, with the moves played in them
+ * and the results. The file holds the entries sorted by hash and move in
+ * blocks of one page each, preceded by the first hash of every block. A
+ * lookup bisects the block hashes, which are few and stay in memory, and then
+ * only touches the one or two pages of the position itself.
+ */
+class PositionIndex {
+
+public:
+	static constexpr uint64_t NO_MOVE = 0;
+
+public:
+	bool Open(const std::string& file);
+	bool IsOpen() const;
+	size_t GetSize() const;
+
+	/**
+	 * Returns the range of entries of the position with the given hash.
+	 */
+	std::pair<const PositionIndexEntry *, const PositionIndexEntry *> Find(uint64_t hash) const;
+
+	/**
+	 * Returns the number of games that reached the position, and their results.
+	 * A game that reached the position more than once is counted once, with
+	 * the move it played the first time.
+	 */
+	PositionStatistics GetStatistics(uint64_t hash) const;
+
+	/**
+	 * Sorts the entries and writes them as an index file.
+	 */
+	static bool Write(const std::string& file, std::vector<PositionIndexEntry> entries);
+
+private:
+	MappedFile _file;
+	const uint64_t *_block_hashes = nullptr;
+	const PositionIndexEntry *_entries = nullptr;
+	size_t _block_count = 0;
+	size_t _count = 0;
+
+private:
+	struct _Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t count;
+		uint64_t block_count;
+		uint64_t entries_offset;
+	};
+
+	static constexpr char _MAGIC[4] = { 'P', 'S', 'P', 'I' };
+	static constexpr uint32_t _VERSION = 1;
+	static constexpr size_t _PAGE_SIZE = 4096;
+	static constexpr size_t _BLOCK_SIZE = _PAGE_SIZE / sizeof(PositionIndexEntry);
+
+};
+
+/**
+ * Builds a position index by replaying archived games. The games are
+ * replayed in batches on a thread pool, and each batch is merged into the
+ * statistics when it is done.
+ */
+class PositionIndexer {
+
+public:
+	PositionIndexer(size_t threadCount = std::thread::hardware_concurrency());
+
+	/**
+	 * Replays the game and counts its positions. Returns false if the start
+	 * position is invalid or a move is illegal, in which case nothing is
+	 * counted and the game is counted as skipped.
+	 */
+	bool Add(const GameRecord& record);
+
+	/**
+	 * Adds all games of a record file. Returns false if the file could not be
+	 * read to the end. Invalid games are skipped.
+	 */
+	bool AddArchive(const std::string& file);
+
+	size_t GetGameCount() const;
+	size_t GetSkippedCount() const;
+	size_t GetSize() const;
+
+	bool Write(const std::string& file) const;
+
+private:
+	struct _Key {
+		uint64_t hash;
+		uint64_t move;
+
+		bool operator==(const _Key& key) const {
+			return hash == key.hash && move == key.move;
+		}
+	};
+
+	struct _KeyHash {
+		size_t operator()(const _Key& key) const {
+			return size_t(key.hash ^ (key.move * 0x9e3779b97f4a7c15ull));
+		}
+	};
+
+	using _Statistics = std::unordered_map<_Key, PositionIndexEntry, _KeyHash>;
+
+	static bool _Replay(const GameRecord& record, _Statistics& statistics);
+	void _Merge(const _Statistics& statistics, size_t games, size_t skipped);
+
+	size_t _thread_count;
+
+	mutable std::mutex _mutex;
+	_Statistics _statistics;
+	size_t _game_count = 0;
+	size_t _skipped_count = 0;
+
+private:
+	static constexpr size_t _BATCH_SIZE = 256;
+
+};
+
+}
+
+#endif
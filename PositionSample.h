@@ -0,0 +1,51 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef POSITIONSAMPLE_H_
+#define POSITIONSAMPLE_H_
+
+#include "PackedPosition.h"
+
+#include <cstdint>
+
+namespace ps {
+
+/**
+ * A position of a played game with its evaluation and the result of the game,
+ * as stored in training data. Files of samples are the raw records one after
+ * another.
+ */
+struct PositionSample {
+	PackedPosition position;
+
+	// the score in centipawns, from the white side.
+	int16_t score;
+
+	// the result of the game: 1 if white won, -1 if black won, 0 for a draw.
+	int8_t result;
+	uint8_t reserved;
+};
+
+static_assert(sizeof(PositionSample) == 36, "position samples must be packed");
+
+/**
+ * The aggregate of all samples of a position.
+ */
+struct PositionOutcomes {
+	// the position, with the move counters of one of the samples.
+	PackedPosition position;
+
+	uint32_t count;
+	uint32_t white_wins;
+	uint32_t black_wins;
+	uint32_t draws;
+
+	// the sum of the scores of the samples.
+	int64_t score_sum;
+};
+
+static_assert(sizeof(PositionOutcomes) == 56, "position outcomes must be packed");
+
+}
+
+#endif
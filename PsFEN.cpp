@@ -0,0 +1,463 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "PsFEN.h"
+
+#include <algorithm>
+#include <array>
+#include <system_error>
+
+namespace ps {
+
+/**
+ * A cursor over the input that fails with the position of the cursor.
+ */
+class PsFENReader {
+
+public:
+	PsFENReader(std::string_view fen, PsFENError *error) :
+			_fen(fen),
+			_error(error) {}
+
+	bool AtEnd() const {
+		return _position >= _fen.size();
+	}
+
+	char Peek() const {
+		return AtEnd() ? '\0' : _fen[_position];
+	}
+
+	char Next() {
+		return AtEnd() ? '\0' : _fen[_position++];
+	}
+
+	bool Expect(char c, const char *message) {
+		if (Peek() != c) {
+			return Fail(message);
+		}
+
+		_position++;
+		return true;
+	}
+
+	bool ReadInteger(int& value, const char *message) {
+		const char *first = _fen.data() + _position;
+		const char *last = _fen.data() + _fen.size();
+
+		if (first == last || *first < '0' || *first > '9') {
+			return Fail(message);
+		}
+
+		auto result = std::from_chars(first, last, value);
+		if (result.ec != std::errc()) {
+			return Fail(message);
+		}
+
+		_position += size_t(result.ptr - first);
+		return true;
+	}
+
+	bool Fail(const char *message) {
+		return Fail(_position, message);
+	}
+
+	bool Fail(size_t position, const char *message) {
+		if (_error) {
+			_error->position = position;
+			_error->message = message;
+		}
+
+		return false;
+	}
+
+	size_t GetPosition() const {
+		return _position;
+	}
+
+	void Skip(size_t count) {
+		_position += count;
+	}
+
+	std::string_view GetRemaining() const {
+		return _fen.substr(std::min(_position, _fen.size()));
+	}
+
+private:
+	std::string_view _fen;
+	PsFENError *_error;
+	size_t _position = 0;
+
+};
+
+/**
+ * Appends to the output without passing its end.
+ */
+class PsFENWriter {
+
+public:
+	PsFENWriter(char *first, char *last) :
+			_current(first),
+			_last(last) {}
+
+	void Put(char c) {
+		if (_current == _last) {
+			_full = true;
+			return;
+		}
+
+		*_current++ = c;
+	}
+
+	void PutInteger(int value) {
+		auto result = std::to_chars(_current, _last, value);
+
+		if (result.ec != std::errc()) {
+			_full = true;
+			return;
+		}
+
+		_current = result.ptr;
+	}
+
+	std::to_chars_result GetResult() const {
+		if (_full) {
+			return { _last, std::errc::value_too_large };
+		}
+
+		return { _current, std::errc() };
+	}
+
+private:
+	char *_current;
+	char *_last;
+	bool _full = false;
+
+};
+
+/**
+ * The piece types of the PsFEN characters, indexed by character, and the
+ * pieces indexed by white type * 7 + black type, so the board can be parsed
+ * without a switch or a piece constructor for every square.
+ */
+struct PieceTable {
+	std::array<Piece::Type, 256> white {};
+	std::array<Piece::Type, 256> black {};
+	std::array<Piece, 49> pieces;
+
+	PieceTable() {
+		for (int c = 0; c < 256; c++) {
+			white[c] = getTypeWhite(char(c));
+			black[c] = getTypeBlack(char(c));
+		}
+
+		for (int i = 0; i < 49; i++) {
+			pieces[i] = Piece(Piece::Type(i / 7), Piece::Type(i % 7));
+		}
+	}
+};
+
+static const PieceTable pieceTable;
+
+static uint8_t pieceCode(Piece::Type whiteType, Piece::Type blackType) {
+	return uint8_t(int(whiteType) * 7 + int(blackType));
+}
+
+/**
+ * Parses the board into piece codes, because the board may only be changed
+ * once the whole PsFEN is known to be valid.
+ */
+static bool parseBoard(PsFENReader& reader, std::array<std::array<uint8_t, 8>, 8>& squares) {
+	for (int r = 7; r >= 0; r--) {
+		int c = 0;
+
+		while (c < 8) {
+			char ch = reader.Peek();
+
+			if ('1' <= ch && ch <= '8') {
+				int count = ch - '0';
+
+				if (c + count > 8) {
+					return reader.Fail("too many squares in rank");
+				}
+
+				for (int i = 0; i < count; i++) {
+					squares[r][c++] = 0;
+				}
+
+				reader.Skip(1);
+				continue;
+			}
+
+			if (ch == 'U') {
+				reader.Skip(1);
+
+				auto whiteType = pieceTable.white[uint8_t(reader.Peek())];
+				if (whiteType == Piece::Type::NONE) {
+					return reader.Fail("expected white piece in union");
+				}
+
+				reader.Skip(1);
+
+				auto blackType = pieceTable.black[uint8_t(reader.Peek())];
+				if (blackType == Piece::Type::NONE) {
+					return reader.Fail("expected black piece in union");
+				}
+
+				reader.Skip(1);
+				squares[r][c++] = pieceCode(whiteType, blackType);
+				continue;
+			}
+
+			auto whiteType = pieceTable.white[uint8_t(ch)];
+			auto blackType = pieceTable.black[uint8_t(ch)];
+
+			if (whiteType == Piece::Type::NONE && blackType == Piece::Type::NONE) {
+				return reader.Fail(reader.AtEnd() ? "unexpected end of board" : "expected piece or empty square count");
+			}
+
+			reader.Skip(1);
+			squares[r][c++] = pieceCode(whiteType, blackType);
+		}
+
+		if (r > 0 && !reader.Expect('/', "expected end of rank")) {
+			return false;
+		}
+	}
+
+	if (!reader.AtEnd() && reader.Peek() != ' ') {
+		return reader.Fail("expected end of board");
+	}
+
+	return true;
+}
+
+void PsFEN::_SetBoard(Board& board, const _Squares& squares) {
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			board._squares[r][c] = pieceTable.pieces[squares[r][c]];
+		}
+	}
+}
+
+bool PsFEN::ParseBoard(std::string_view fen, Board& board, PsFENError *error) {
+	PsFENReader reader(fen, error);
+	_Squares squares;
+
+	if (!parseBoard(reader, squares)) {
+		return false;
+	}
+
+	_SetBoard(board, squares);
+	return true;
+}
+
+bool PsFEN::Parse(std::string_view fen, PsFENPosition& position, PsFENError *error) {
+	return Parse(fen, position.board, position.player, position.move_data,
+			position.fifty_move_rule_count, position.move_number, error);
+}
+
+bool PsFEN::Parse(std::string_view fen, Board& board, Piece::Color& player, GameMoveData& moveData,
+		int& fiftyMoveRuleCount, int& moveNumber, PsFENError *error) {
+
+	PsFENReader reader(fen, error);
+	_Squares squares;
+	Piece::Color currentPlayer;
+	GameMoveData currentMoveData;
+	int fiftyMoves, currentMove;
+
+	if (!parseBoard(reader, squares) || !reader.Expect(' ', "expected space after board")) {
+		return false;
+	}
+
+	// the current player
+	char color = reader.Next();
+
+	if (color == 'w') {
+		currentPlayer = Piece::Color::WHITE;
+	} else if (color == 'b') {
+		currentPlayer = Piece::Color::BLACK;
+	} else {
+		return reader.Fail(reader.GetPosition() - (color != '\0'), "expected w or b");
+	}
+
+	if (!reader.Expect(' ', "expected space after player")) {
+		return false;
+	}
+
+	// the castling possibilities, in the order KQkq
+	currentMoveData.can_white_castle_king_side = false;
+	currentMoveData.can_white_castle_queen_side = false;
+	currentMoveData.can_black_castle_king_side = false;
+	currentMoveData.can_black_castle_queen_side = false;
+
+	if (reader.Peek() == '-') {
+		reader.Skip(1);
+	} else {
+		static constexpr char ORDER[] = "KQkq";
+		bool *rights[] = {
+			&currentMoveData.can_white_castle_king_side, &currentMoveData.can_white_castle_queen_side,
+			&currentMoveData.can_black_castle_king_side, &currentMoveData.can_black_castle_queen_side
+		};
+
+		int next = 0;
+		size_t start = reader.GetPosition();
+
+		while (reader.Peek() != ' ' && !reader.AtEnd()) {
+			while (next < 4 && ORDER[next] != reader.Peek()) {
+				next++;
+			}
+
+			if (next == 4) {
+				return reader.Fail("expected castling rights KQkq or -");
+			}
+
+			*rights[next++] = true;
+			reader.Skip(1);
+		}
+
+		if (reader.GetPosition() == start) {
+			return reader.Fail("expected castling rights KQkq or -");
+		}
+	}
+
+	if (!reader.Expect(' ', "expected space after castling rights")) {
+		return false;
+	}
+
+	// the en passant position is the square the pawn skipped, but the move
+	// data holds the position of the pawn itself.
+	if (reader.Peek() == '-') {
+		reader.Skip(1);
+	} else {
+		std::string_view square = reader.GetRemaining().substr(0, 2);
+
+		if (square.size() < 2 || square[0] < 'a' || square[0] > 'h' || square[1] < '1' || square[1] > '8') {
+			return reader.Fail("expected en passant square or -");
+		}
+
+		int column = square[0] - 'a';
+		int row = square[1] - '1';
+		row += row <= 3 ? 1 : -1;
+
+		currentMoveData.en_passant_position = { row, column };
+		reader.Skip(2);
+	}
+
+	if (!reader.Expect(' ', "expected space after en passant square")) {
+		return false;
+	}
+
+	// the move counts
+	if (!reader.ReadInteger(fiftyMoves, "expected fifty move rule count") ||
+			!reader.Expect(' ', "expected space after fifty move rule count") ||
+			!reader.ReadInteger(currentMove, "expected move number")) {
+		return false;
+	}
+
+	if (!reader.AtEnd()) {
+		return reader.Fail("expected end of PsFEN");
+	}
+
+	_SetBoard(board, squares);
+	player = currentPlayer;
+	moveData = currentMoveData;
+	fiftyMoveRuleCount = fiftyMoves;
+	moveNumber = currentMove;
+	return true;
+}
+
+void PsFEN::_FormatBoard(PsFENWriter& writer, const Board& board) {
+	for (int r = 7; r >= 0; r--) {
+		if (r < 7) {
+			writer.Put('/');
+		}
+
+		int empty = 0;
+
+		for (int c = 0; c < 8; c++) {
+			const Piece& piece = board._squares[r][c];
+
+			if (piece.GetColor() == Piece::Color::EMPTY) {
+				empty++;
+				continue;
+			} else if (empty > 0) {
+				writer.Put(char('0' + empty));
+				empty = 0;
+			}
+
+			switch (piece.GetColor()) {
+				case Piece::Color::WHITE:
+					writer.Put(getTypeCharWhite(piece.GetWhiteType()));
+					break;
+				case Piece::Color::BLACK:
+					writer.Put(getTypeCharBlack(piece.GetBlackType()));
+					break;
+				case Piece::Color::UNION:
+					writer.Put('U');
+					writer.Put(getTypeCharWhite(piece.GetWhiteType()));
+					writer.Put(getTypeCharBlack(piece.GetBlackType()));
+					break;
+				case Piece::Color::EMPTY:
+					break;
+			}
+		}
+
+		if (empty > 0) {
+			writer.Put(char('0' + empty));
+		}
+	}
+}
+
+std::to_chars_result PsFEN::FormatBoard(char *first, char *last, const Board& board) {
+	PsFENWriter writer(first, last);
+	_FormatBoard(writer, board);
+	return writer.GetResult();
+}
+
+std::to_chars_result PsFEN::Format(char *first, char *last, const Board& board, Piece::Color player,
+		const GameMoveData& moveData, int fiftyMoveRuleCount, int moveNumber) {
+
+	PsFENWriter writer(first, last);
+	_FormatBoard(writer, board);
+
+	writer.Put(' ');
+	writer.Put(player == Piece::Color::WHITE ? 'w' : 'b');
+	writer.Put(' ');
+
+	if (moveData.can_white_castle_king_side || moveData.can_white_castle_queen_side ||
+			moveData.can_black_castle_king_side || moveData.can_black_castle_queen_side) {
+
+		if (moveData.can_white_castle_king_side) writer.Put('K');
+		if (moveData.can_white_castle_queen_side) writer.Put('Q');
+		if (moveData.can_black_castle_king_side) writer.Put('k');
+		if (moveData.can_black_castle_queen_side) writer.Put('q');
+	} else {
+		writer.Put('-');
+	}
+
+	writer.Put(' ');
+
+	const BoardPosition& ep = moveData.en_passant_position;
+
+	if (ep.IsValid()) {
+		int row = ep.GetRow() <= 3 ? ep.GetRow() - 1 : ep.GetRow() + 1;
+		writer.Put(char('a' + ep.GetColumn()));
+		writer.Put(char('1' + row));
+	} else {
+		writer.Put('-');
+	}
+
+	writer.Put(' ');
+	writer.PutInteger(fiftyMoveRuleCount);
+	writer.Put(' ');
+	writer.PutInteger(moveNumber);
+
+	return writer.GetResult();
+}
+
+std::to_chars_result PsFEN::Format(char *first, char *last, const PsFENPosition& position) {
+	return Format(first, last, position.board, position.player, position.move_data,
+			position.fifty_move_rule_count, position.move_number);
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef PSFEN_H_
+#define PSFEN_H_
+
+#include "Board.h"
+#include "GameMoveData.h"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace ps {
+
+class PsFENWriter;
+
+/**
+ * The fields of a PsFEN.
+ */
+struct PsFENPosition {
+	Board board;
+	Piece::Color player = Piece::Color::WHITE;
+	GameMoveData move_data;
+	int fifty_move_rule_count = 0;
+	int move_number = 1;
+};
+
+/**
+ * Where and why a PsFEN could not be parsed. The position is the offset of
+ * the offending character in the input.
+ */
+struct PsFENError {
+	size_t position = 0;
+	const char *message = "";
+};
+
+/**
+ * Parsing and formatting of PsFEN without allocations. The parsers read only
+ * inside the given view, and the formatters write into a buffer of the
+ * caller like std::to_chars, so a corpus can be read and written without
+ * going through strings and streams for every position.
+ */
+class PsFEN {
+
+public:
+	// enough for any position: 8 ranks of 8 unions, all fields and two
+	// 32 bit counters.
+	static constexpr size_t MAX_LENGTH = 256;
+
+public:
+	/**
+	 * Parses the board field, which ends at the end of the view or at the
+	 * first space. The board is only changed on success.
+	 */
+	static bool ParseBoard(std::string_view fen, Board& board, PsFENError *error = nullptr);
+
+	/**
+	 * Parses all six fields. The outputs are only changed on success.
+	 */
+	static bool Parse(std::string_view fen, PsFENPosition& position, PsFENError *error = nullptr);
+	static bool Parse(std::string_view fen, Board& board, Piece::Color& player, GameMoveData& moveData,
+			int& fiftyMoveRuleCount, int& moveNumber, PsFENError *error = nullptr);
+
+	/**
+	 * Writes the board field or the full PsFEN into [first, last). On success
+	 * ptr points past the last character written, otherwise ec is
+	 * value_too_large and ptr is last. Nothing is null terminated.
+	 */
+	static std::to_chars_result FormatBoard(char *first, char *last, const Board& board);
+	static std::to_chars_result Format(char *first, char *last, const Board& board, Piece::Color player,
+			const GameMoveData& moveData, int fiftyMoveRuleCount, int moveNumber);
+	static std::to_chars_result Format(char *first, char *last, const PsFENPosition& position);
+
+private:
+	// the squares of a board while it is parsed, as white type * 7 + black type.
+	using _Squares = std::array<std::array<uint8_t, 8>, 8>;
+
+	static void _SetBoard(Board& board, const _Squares& squares);
+	static void _FormatBoard(PsFENWriter& writer, const Board& board);
+
+};
+
+}
+
+#endif
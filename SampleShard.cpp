@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "SampleShard.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <zlib.h>
+
+namespace ps {
+
+struct SampleShardHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t count;
+	uint32_t compressed_size;
+	uint32_t crc;
+	uint32_t reserved;
+};
+
+static constexpr char SHARD_MAGIC[4] = { 'P', 'S', 'S', 'S' };
+static constexpr uint32_t SHARD_VERSION = 1;
+
+SampleShardWriter::SampleShardWriter(size_t samplesPerShard) :
+		_samples_per_shard(std::max<size_t>(samplesPerShard, 1)) {}
+
+SampleShardWriter::~SampleShardWriter() {
+	Close();
+}
+
+bool SampleShardWriter::Open(const std::string& directory, const std::string& prefix) {
+	Close();
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	if (!std::filesystem::is_directory(directory, error)) {
+		return false;
+	}
+
+	_directory = directory;
+	_prefix = prefix;
+	_filling.clear();
+	_filling.reserve(_samples_per_shard);
+	_writing.reserve(_samples_per_shard);
+	_has_shard = false;
+	_closing = false;
+	_shard_count = 0;
+	_sample_count = 0;
+	_failed = false;
+
+	_thread = std::thread(&SampleShardWriter::_WriterMain, this);
+	return true;
+}
+
+bool SampleShardWriter::Close() {
+	if (!_thread.joinable()) {
+		return !_failed;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_shard_written.wait(lock, [this]() { return !_has_shard; });
+
+		if (!_filling.empty()) {
+			std::swap(_filling, _writing);
+			_has_shard = true;
+		}
+
+		_closing = true;
+	}
+
+	_shard_full.notify_one();
+	_thread.join();
+
+	return !_failed;
+}
+
+void SampleShardWriter::Add(const std::vector<PositionSample>& samples) {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	for (size_t i = 0; i < samples.size(); ) {
+		size_t count = std::min(samples.size() - i, _samples_per_shard - _filling.size());
+		_filling.insert(_filling.end(), samples.begin() + i, samples.begin() + i + count);
+		i += count;
+
+		if (_filling.size() == _samples_per_shard) {
+			// hand the full buffer to the writer, waiting for the previous
+			// shard if it is still being written.
+			_shard_written.wait(lock, [this]() { return !_has_shard; });
+			std::swap(_filling, _writing);
+			_has_shard = true;
+			_shard_full.notify_one();
+		}
+	}
+}
+
+size_t SampleShardWriter::GetShardCount() const {
+	return _shard_count;
+}
+
+uint64_t SampleShardWriter::GetSampleCount() const {
+	return _sample_count;
+}
+
+void SampleShardWriter::_WriterMain() {
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (true) {
+		_shard_full.wait(lock, [this]() { return _has_shard || _closing; });
+
+		if (!_has_shard) {
+			break;
+		}
+
+		// the producers do not touch the buffer that is being written, so it
+		// is compressed without holding the lock.
+		lock.unlock();
+
+		if (!_WriteShard(_writing, _shard_count)) {
+			_failed = true;
+		}
+
+		_shard_count++;
+		_sample_count += _writing.size();
+		_writing.clear();
+
+		lock.lock();
+		_has_shard = false;
+		_shard_written.notify_all();
+	}
+}
+
+bool SampleShardWriter::_WriteShard(const std::vector<PositionSample>& samples, size_t index) const {
+	const Bytef *data = reinterpret_cast<const Bytef *>(samples.data());
+	uLong size = uLong(samples.size() * sizeof(PositionSample));
+
+	std::vector<Bytef> compressed(compressBound(size));
+	uLongf compressedSize = uLongf(compressed.size());
+
+	if (compress2(compressed.data(), &compressedSize, data, size, Z_DEFAULT_COMPRESSION) != Z_OK) {
+		return false;
+	}
+
+	SampleShardHeader header {};
+	std::copy(SHARD_MAGIC, SHARD_MAGIC + 4, header.magic);
+	header.version = SHARD_VERSION;
+	header.count = uint32_t(samples.size());
+	header.compressed_size = uint32_t(compressedSize);
+	header.crc = uint32_t(crc32(0, data, size));
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "-%06zu.pss", index);
+
+	std::filesystem::path path(_directory);
+	path /= _prefix + name;
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char *>(compressed.data()), std::streamsize(compressedSize));
+
+	return bool(out);
+}
+
+bool SampleShardReader::Read(const std::string& file, std::vector<PositionSample>& samples) {
+	std::ifstream in(file, std::ios::binary);
+
+	SampleShardHeader header;
+	if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+			!std::equal(header.magic, header.magic + 4, SHARD_MAGIC) || header.version != SHARD_VERSION) {
+		return false;
+	}
+
+	std::vector<Bytef> compressed(header.compressed_size);
+	if (!in.read(reinterpret_cast<char *>(compressed.data()), std::streamsize(compressed.size()))) {
+		return false;
+	}
+
+	samples.resize(header.count);
+	uLongf size = uLongf(samples.size() * sizeof(PositionSample));
+	Bytef *data = reinterpret_cast<Bytef *>(samples.data());
+
+	if (uncompress(data, &size, compressed.data(), uLong(compressed.size())) != Z_OK ||
+			size != samples.size() * sizeof(PositionSample) || crc32(0, data, uInt(size)) != header.crc) {
+		samples.clear();
+		return false;
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef SAMPLESHARD_H_
+#define SAMPLESHARD_H_
+
+#include "PositionSample.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ps {
+
+/**
+ * Writes position samples into compressed shard files of a fixed number of
+ * samples each, only the last shard of a run may be smaller. A shard is a
+ * header followed by the samples, deflated with zlib:
+ *
+ *   char[4] magic "PSSS"
+ *   u32     version
+ *   u32     number of samples
+ *   u32     compressed size
+ *   u32     CRC-32 of the uncompressed samples
+ *   u32     reserved
+ *
+ * Samples are collected in one buffer while a writer thread compresses and
+ * writes the other, so producers only wait if the writer falls a whole shard
+ * behind.
+ */
+class SampleShardWriter {
+
+public:
+	SampleShardWriter(size_t samplesPerShard = size_t(1) << 16);
+	~SampleShardWriter();
+
+	SampleShardWriter(const SampleShardWriter&) = delete;
+	SampleShardWriter& operator=(const SampleShardWriter&) = delete;
+
+	/**
+	 * Starts writing shards named <prefix>-000000.pss, <prefix>-000001.pss and
+	 * so on in the directory.
+	 */
+	bool Open(const std::string& directory, const std::string& prefix = "samples");
+
+	/**
+	 * Writes the last shard and waits for the writer. Returns false if any
+	 * shard could not be written.
+	 */
+	bool Close();
+
+	/**
+	 * Adds samples. Can be called from any thread.
+	 */
+	void Add(const std::vector<PositionSample>& samples);
+
+	size_t GetShardCount() const;
+	uint64_t GetSampleCount() const;
+
+private:
+	void _WriterMain();
+	bool _WriteShard(const std::vector<PositionSample>& samples, size_t index) const;
+
+	size_t _samples_per_shard;
+	std::string _directory;
+	std::string _prefix;
+
+	std::mutex _mutex;
+	std::condition_variable _shard_full;
+	std::condition_variable _shard_written;
+
+	// the buffer that is being filled, and the one that is being written.
+	std::vector<PositionSample> _filling;
+	std::vector<PositionSample> _writing;
+	bool _has_shard = false;
+	bool _closing = false;
+
+	std::thread _thread;
+	std::atomic<size_t> _shard_count { 0 };
+	std::atomic<uint64_t> _sample_count { 0 };
+	std::atomic_bool _failed { false };
+
+};
+
+class SampleShardReader {
+
+public:
+	/**
+	 * Reads all samples of a shard. Returns false if the file is not a shard
+	 * or is corrupt.
+	 */
+	static bool Read(const std::string& file, std::vector<PositionSample>& samples);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "SearchStatistics.h"
+
+namespace ps {
+
+static double perSecond(uint64_t count, std::chrono::microseconds time) {
+	if (time.count() == 0) {
+		return 0.0;
+	}
+
+	return double(count) * 1e6 / double(time.count());
+}
+
+static double milliseconds(std::chrono::nanoseconds time) {
+	return double(time.count()) / 1e6;
+}
+
+double SearchStatistics::GetNodesPerSecond() const {
+	return perSecond(nodes, time);
+}
+
+double SearchStatistics::GetPlayoutsPerSecond() const {
+	return perSecond(playouts, time);
+}
+
+double SearchStatistics::GetCollisionRate() const {
+	return playouts == 0 ? 0.0 : double(collisions) / double(playouts);
+}
+
+StatisticsSink::~StatisticsSink() {}
+
+StreamStatisticsSink::StreamStatisticsSink(std::ostream& out) :
+		_out(out) {}
+
+void LastSearchStatisticsSink::ReportSearch(const SearchStatistics& statistics) {
+	_last = statistics;
+}
+
+void LastSearchStatisticsSink::ReportMove(const Move& move, const std::string& psFEN) {}
+
+const SearchStatistics& LastSearchStatisticsSink::GetLast() const {
+	return _last;
+}
+
+void LastSearchStatisticsSink::Clear() {
+	_last = SearchStatistics();
+}
+
+void StreamStatisticsSink::ReportSearch(const SearchStatistics& statistics) {
+	_out << (statistics.player == Piece::Color::WHITE ? "white" : "black")
+			<< " search: " << statistics.best_move
+			<< ", score " << statistics.score
+			<< ", time " << statistics.time.count() / 1000 << " ms"
+			<< ", nodes " << statistics.nodes << " (" << uint64_t(statistics.GetNodesPerSecond()) << "/s)"
+			<< ", playouts " << statistics.playouts << " (" << uint64_t(statistics.GetPlayoutsPerSecond()) << "/s)"
+			<< ", depth " << statistics.depth << "/" << statistics.selective_depth
+			<< ", reused " << statistics.reused_visits
+			<< ", collisions " << statistics.collisions << " (" << statistics.GetCollisionRate() * 100.0 << "%)"
+			<< ", movegen " << milliseconds(statistics.chain_generation_time) << " ms"
+			<< ", legality " << milliseconds(statistics.legality_time) << " ms" << std::endl;
+}
+
+void StreamStatisticsSink::ReportMove(const Move& move, const std::string& psFEN) {
+	_out << move << std::endl;
+	_out << psFEN << std::endl;
+}
+
+StreamStatisticsSink& StreamStatisticsSink::Console() {
+	static StreamStatisticsSink console(std::cout);
+	return console;
+}
+
+}
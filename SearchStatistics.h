@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef SEARCHSTATISTICS_H_
+#define SEARCHSTATISTICS_H_
+
+#include "Move.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ps {
+
+/**
+ * Statistics of a single search for a move.
+ */
+struct SearchStatistics {
+	Piece::Color player = Piece::Color::EMPTY;
+	Move best_move;
+	std::chrono::microseconds time { 0 };
+
+	// the expected result of the best move, as a centipawn score from the
+	// perspective of the player.
+	int score = 0;
+
+	// the number of nodes added to the search tree and the number of playouts.
+	uint64_t nodes = 0;
+	uint64_t playouts = 0;
+
+	// the length of the principal variation, and the deepest ply reached by
+	// any playout, including its rollout.
+	int depth = 0;
+	int selective_depth = 0;
+
+	// the visits of the root that were carried over from an earlier search or
+	// from pondering.
+	uint64_t reused_visits = 0;
+
+	// the playouts that ended in a leaf that was being expanded by another
+	// thread.
+	uint64_t collisions = 0;
+
+	// the time the move generator spent generating (chain) moves and checking
+	// them for legality, summed over all search threads.
+	std::chrono::nanoseconds chain_generation_time { 0 };
+	std::chrono::nanoseconds legality_time { 0 };
+
+	double GetNodesPerSecond() const;
+	double GetPlayoutsPerSecond() const;
+	double GetCollisionRate() const;
+};
+
+/**
+ * Receives the statistics of searches and the moves made in a game.
+ */
+class StatisticsSink {
+
+public:
+	virtual ~StatisticsSink();
+
+	/**
+	 * Will be called by search players after finishing a search, on the game
+	 * loop thread.
+	 */
+	virtual void ReportSearch(const SearchStatistics& statistics) = 0;
+
+	/**
+	 * Will be called by the host game after a move was made, with the PsFEN of
+	 * the resulting position.
+	 */
+	virtual void ReportMove(const Move& move, const std::string& psFEN) = 0;
+
+};
+
+/**
+ * Keeps the statistics of the last search, for callers that run a search and
+ * want its results.
+ */
+class LastSearchStatisticsSink : public StatisticsSink {
+
+public:
+	void ReportSearch(const SearchStatistics& statistics) override;
+	void ReportMove(const Move& move, const std::string& psFEN) override;
+
+	const SearchStatistics& GetLast() const;
+	void Clear();
+
+private:
+	SearchStatistics _last;
+
+};
+
+/**
+ * Writes the statistics to an output stream.
+ */
+class StreamStatisticsSink : public StatisticsSink {
+
+public:
+	StreamStatisticsSink(std::ostream& out);
+
+	void ReportSearch(const SearchStatistics& statistics) override;
+	void ReportMove(const Move& move, const std::string& psFEN) override;
+
+	static StreamStatisticsSink& Console();
+
+private:
+	std::ostream& _out;
+
+};
+
+}
+
+#endif
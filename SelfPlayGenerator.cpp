@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "SelfPlayGenerator.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace ps {
+
+SelfPlayGenerator::SelfPlayGenerator(const SelfPlaySettings& settings) :
+		_settings(settings),
+		_writer(settings.samples_per_shard) {
+
+	_settings.threads = std::max<size_t>(_settings.threads, 1);
+	_settings.multi_pv = std::max<size_t>(_settings.multi_pv, 1);
+}
+
+bool SelfPlayGenerator::Run(const std::string& directory) {
+	if (!_writer.Open(directory)) {
+		return false;
+	}
+
+	_next_game = 0;
+
+	{
+		ThreadPool pool(_settings.threads);
+
+		for (size_t i = 0; i < _settings.threads; i++) {
+			pool.Submit([this]() { _WorkerMain(); });
+		}
+	}
+
+	return _writer.Close();
+}
+
+const SelfPlaySummary& SelfPlayGenerator::GetSummary() const {
+	return _summary;
+}
+
+void SelfPlayGenerator::_WorkerMain() {
+	LastSearchStatisticsSink sink;
+	std::array<std::unique_ptr<AiMcts>, 2> players;
+
+	for (int i = 0; i < 2; i++) {
+		Piece::Color color = i == 0 ? Piece::Color::WHITE : Piece::Color::BLACK;
+		// the players search on this worker, without threads of their own
+		players[i] = std::make_unique<AiMcts>(color, _settings.move_time, _settings.playouts, 0);
+		players[i]->SetStatisticsSink(&sink);
+
+		// a playout limit makes every search the same size, whatever the time
+		if (_settings.playouts > 0) {
+			players[i]->SetMoveTime(std::chrono::hours(24));
+		}
+	}
+
+	std::vector<PositionSample> samples;
+
+	for (uint64_t index = _next_game++; index < _settings.games; index = _next_game++) {
+		_PlayGame(index, players, sink, samples);
+		_writer.Add(samples);
+	}
+}
+
+void SelfPlayGenerator::_PlayGame(uint64_t index, std::array<std::unique_ptr<AiMcts>, 2>& players, LastSearchStatisticsSink& sink, std::vector<PositionSample>& samples) {
+	std::mt19937_64 rng(_settings.seed * 0x9e3779b97f4a7c15ull + index);
+	std::atomic_bool stop { false };
+
+	Game game;
+	samples.clear();
+
+	for (auto& player : players) {
+		player->SetPositionHistory(&game.GetHistory());
+	}
+
+	int8_t result = 0;
+
+	for (int ply = 0; ; ply++) {
+		Piece::Color color = game.GetPlayerColor();
+		auto possible = game.GetBoard().GetAllPossibleMoves(color, game.GetMoveData());
+
+		if (possible.empty()) {
+			if (game.GetBoard().IsSako(color, game.GetMoveData())) {
+				result = color == Piece::Color::WHITE ? -1 : 1;
+			}
+
+			break;
+		}
+
+		if (ply >= _settings.max_plies || _IsDrawn(game)) {
+			break;
+		}
+
+		if (ply < _settings.random_plies) {
+			std::uniform_int_distribution<size_t> dist(0, possible.size() - 1);
+			game.MakeMove(possible[dist(rng)]);
+			continue;
+		}
+
+		AiMcts& player = *players[color == Piece::Color::BLACK];
+		sink.Clear();
+
+		Move move = player.MakeMove(game.GetBoard(), game.GetMoveData(), possible, stop);
+
+		// forced, book and tablebase moves are not searched, and their
+		// positions have no score to learn from.
+		if (sink.GetLast().player == color) {
+			PositionSample sample {};
+
+			if (PackedPosition::Pack(game, sample.position)) {
+				int score = std::clamp(sink.GetLast().score, -32000, 32000);
+				sample.score = int16_t(color == Piece::Color::WHITE ? score : -score);
+				samples.push_back(sample);
+			}
+
+			move = _ChooseMove(player, move, rng);
+		}
+
+		game.MakeMove(move);
+	}
+
+	for (auto& player : players) {
+		player->SetPositionHistory(nullptr);
+	}
+
+	for (PositionSample& sample : samples) {
+		sample.result = result;
+	}
+
+	_summary.games++;
+	_summary.samples += samples.size();
+	(result > 0 ? _summary.white_wins : result < 0 ? _summary.black_wins : _summary.draws)++;
+}
+
+Move SelfPlayGenerator::_ChooseMove(const AiMcts& player, const Move& best, std::mt19937_64& rng) const {
+	if (_settings.multi_pv <= 1) {
+		return best;
+	}
+
+	std::vector<MctsRootMove> moves = player.GetRootMoves();
+	if (moves.empty()) {
+		return best;
+	}
+
+	// the alternatives have to be close to the best move, and searched enough
+	// for their score to mean something.
+	int bestScore = moves.front().score;
+	size_t count = 1;
+
+	while (count < std::min(_settings.multi_pv, moves.size()) &&
+			moves[count].score >= bestScore - _settings.multi_pv_margin && moves[count].visits > 0) {
+		count++;
+	}
+
+	std::uniform_int_distribution<size_t> dist(0, count - 1);
+	return moves[dist(rng)].move;
+}
+
+bool SelfPlayGenerator::_IsDrawn(const Game& game) {
+	if (game.GetFiftyMoveRuleCount() >= 100 || game.IsRepetition()) {
+		return true;
+	}
+
+	// like the game, a board on which all pieces are united is a draw
+	int unionCount = 0;
+
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			unionCount += game.GetBoard()[{ r, c }].GetColor() == Piece::Color::UNION;
+		}
+	}
+
+	return unionCount == 15;
+}
+
+}
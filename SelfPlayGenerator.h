@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef SELFPLAYGENERATOR_H_
+#define SELFPLAYGENERATOR_H_
+
+#include "AiMcts.h"
+#include "Game.h"
+#include "PositionSample.h"
+#include "SampleShard.h"
+#include "SearchStatistics.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ps {
+
+struct SelfPlaySettings {
+	size_t games = 1000;
+
+	// the number of games played at the same time. Each game searches on a
+	// single thread.
+	size_t threads = std::thread::hardware_concurrency();
+
+	// the limits of the search of every move. Without a playout limit, the
+	// move time is used.
+	std::chrono::milliseconds move_time { 100 };
+	size_t playouts = 0;
+
+	// the number of plies at the start of every game that are played at
+	// random, so the games start from different openings.
+	int random_plies = 8;
+
+	// the number of root moves to choose from, and how many centipawns worse
+	// than the best move they may be. With a single move, the best move is
+	// always played.
+	size_t multi_pv = 1;
+	int multi_pv_margin = 50;
+
+	// games that are not over after this many plies are drawn.
+	int max_plies = 300;
+
+	size_t samples_per_shard = size_t(1) << 16;
+	uint64_t seed = 1;
+};
+
+struct SelfPlaySummary {
+	std::atomic<uint64_t> games { 0 };
+	std::atomic<uint64_t> white_wins { 0 };
+	std::atomic<uint64_t> black_wins { 0 };
+	std::atomic<uint64_t> draws { 0 };
+	std::atomic<uint64_t> samples { 0 };
+};
+
+/**
+ * Plays games of the search player against itself and writes the searched
+ * positions with their scores and the results of the games into sample
+ * shards. Every worker thread plays whole games with its own players, so the
+ * workers only share the game counter and the shard writer.
+ */
+class SelfPlayGenerator {
+
+public:
+	SelfPlayGenerator(const SelfPlaySettings& settings);
+
+	/**
+	 * Plays all games and writes the shards into the directory. Returns false
+	 * if the shards could not be written.
+	 */
+	bool Run(const std::string& directory);
+
+	const SelfPlaySummary& GetSummary() const;
+
+private:
+	void _WorkerMain();
+	void _PlayGame(uint64_t index, std::array<std::unique_ptr<AiMcts>, 2>& players, LastSearchStatisticsSink& sink, std::vector<PositionSample>& samples);
+	Move _ChooseMove(const AiMcts& player, const Move& best, std::mt19937_64& rng) const;
+
+	static bool _IsDrawn(const Game& game);
+
+	SelfPlaySettings _settings;
+	SelfPlaySummary _summary;
+
+	SampleShardWriter _writer;
+	std::atomic<uint64_t> _next_game { 0 };
+
+};
+
+}
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Socket.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace ps {
+
+#ifdef _WIN32
+
+using NativeHandle = SOCKET;
+
+static bool initialize() {
+	static bool initialized = [] {
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+
+	return initialized;
+}
+
+static void closeHandle(intptr_t handle) {
+	closesocket(NativeHandle(handle));
+}
+
+#else
+
+using NativeHandle = int;
+
+static bool initialize() {
+	return true;
+}
+
+static void closeHandle(intptr_t handle) {
+	close(NativeHandle(handle));
+}
+
+#endif
+
+Socket::~Socket() {
+	Close();
+}
+
+Socket::Socket(Socket&& socket) noexcept {
+	*this = std::move(socket);
+}
+
+Socket& Socket::operator=(Socket&& socket) noexcept {
+	if (this != &socket) {
+		Close();
+
+		std::swap(_handle, socket._handle);
+		std::swap(_buffer, socket._buffer);
+		std::swap(_unix_path, socket._unix_path);
+	}
+
+	return *this;
+}
+
+bool Socket::ListenTcp(uint16_t port) {
+	Close();
+
+	if (!initialize()) {
+		return false;
+	}
+
+	intptr_t handle = intptr_t(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+	if (handle < 0) {
+		return false;
+	}
+
+	int reuse = 1;
+	setsockopt(NativeHandle(handle), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+	sockaddr_in address {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+
+	if (bind(NativeHandle(handle), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+			listen(NativeHandle(handle), SOMAXCONN) != 0) {
+		closeHandle(handle);
+		return false;
+	}
+
+	_handle = handle;
+	return true;
+}
+
+bool Socket::ListenUnix(const std::string& path) {
+#ifdef _WIN32
+	return false;
+#else
+	Close();
+
+	sockaddr_un address {};
+	if (path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+
+	int handle = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (handle < 0) {
+		return false;
+	}
+
+	address.sun_family = AF_UNIX;
+	std::strcpy(address.sun_path, path.c_str());
+	unlink(path.c_str());
+
+	if (bind(handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+			listen(handle, SOMAXCONN) != 0) {
+		close(handle);
+		return false;
+	}
+
+	_handle = handle;
+	_unix_path = path;
+	return true;
+#endif
+}
+
+Socket Socket::Accept() const {
+	Socket connection;
+
+	if (_handle >= 0) {
+		auto handle = accept(NativeHandle(_handle), nullptr, nullptr);
+
+		if (intptr_t(handle) >= 0) {
+			connection._handle = intptr_t(handle);
+		}
+	}
+
+	return connection;
+}
+
+bool Socket::ReadLine(std::string& line) {
+	while (true) {
+		size_t end = _buffer.find('\n');
+
+		if (end != std::string::npos) {
+			line = _buffer.substr(0, end);
+			_buffer.erase(0, end + 1);
+
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+
+			return true;
+		}
+
+		char chunk[4096];
+		auto received = recv(NativeHandle(_handle), chunk, sizeof(chunk), 0);
+
+		if (received <= 0) {
+			return false;
+		}
+
+		_buffer.append(chunk, size_t(received));
+	}
+}
+
+bool Socket::Write(const std::string& data) {
+	size_t sent = 0;
+
+	while (sent < data.size()) {
+#ifdef _WIN32
+		int flags = 0;
+#else
+		int flags = MSG_NOSIGNAL;
+#endif
+		auto count = send(NativeHandle(_handle), data.data() + sent, int(data.size() - sent), flags);
+
+		if (count <= 0) {
+			return false;
+		}
+
+		sent += size_t(count);
+	}
+
+	return true;
+}
+
+void Socket::Shutdown() {
+	if (_handle < 0) {
+		return;
+	}
+
+#ifdef _WIN32
+	shutdown(NativeHandle(_handle), SD_BOTH);
+#else
+	shutdown(NativeHandle(_handle), SHUT_RDWR);
+#endif
+}
+
+void Socket::Close() {
+	if (_handle < 0) {
+		return;
+	}
+
+	closeHandle(_handle);
+	_handle = -1;
+	_buffer.clear();
+
+#ifndef _WIN32
+	if (!_unix_path.empty()) {
+		unlink(_unix_path.c_str());
+		_unix_path.clear();
+	}
+#endif
+}
+
+bool Socket::IsOpen() const {
+	return _handle >= 0;
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef SOCKET_H_
+#define SOCKET_H_
+
+#include <cstdint>
+#include <string>
+
+namespace ps {
+
+/**
+ * A blocking stream socket for local connections, either TCP on the loopback
+ * interface or a Unix domain socket. Lines are read through a buffer, so
+ * ReadLine and Write can be used from different threads.
+ */
+class Socket {
+
+public:
+	Socket() = default;
+	~Socket();
+
+	Socket(const Socket&) = delete;
+	Socket& operator=(const Socket&) = delete;
+
+	Socket(Socket&& socket) noexcept;
+	Socket& operator=(Socket&& socket) noexcept;
+
+	/**
+	 * Listens on the loopback interface only.
+	 */
+	bool ListenTcp(uint16_t port);
+
+	/**
+	 * Listens on a Unix domain socket. An existing socket file at the path is
+	 * replaced. Not available on Windows.
+	 */
+	bool ListenUnix(const std::string& path);
+
+	/**
+	 * Waits for a connection. Returns a closed socket if the listening socket
+	 * was shut down.
+	 */
+	Socket Accept() const;
+
+	/**
+	 * Reads a line without the line ending. Returns false when the
+	 * connection was closed.
+	 */
+	bool ReadLine(std::string& line);
+	bool Write(const std::string& data);
+
+	/**
+	 * Wakes up threads that are blocked on the socket, without releasing it.
+	 */
+	void Shutdown();
+	void Close();
+
+	bool IsOpen() const;
+
+private:
+	intptr_t _handle = -1;
+	std::string _buffer;
+	std::string _unix_path;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace ps {
+
+bool Tablebase::Open(const std::string& directory) {
+	std::error_code error;
+	bool success = true;
+
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		if (entry.path().extension() == _EXTENSION) {
+			success &= Add(entry.path().string());
+		}
+	}
+
+	return !error && success;
+}
+
+bool Tablebase::Add(const std::string& file) {
+	_Table table;
+
+	if (!table.file.Open(file) || table.file.GetSize() < sizeof(_Header)) {
+		return false;
+	}
+
+	_Header header;
+	std::memcpy(&header, table.file.GetData(), sizeof(header));
+	header.name[sizeof(header.name) - 1] = 0;
+
+	if (!std::equal(header.magic, header.magic + 4, _MAGIC) || header.version != _VERSION ||
+			!MaterialSignature::Parse(header.name, table.signature) ||
+			table.file.GetSize() != sizeof(_Header) + table.signature.GetPositionCount()) {
+		return false;
+	}
+
+	table.values = table.file.GetData() + sizeof(_Header);
+
+	std::string name = table.signature.GetName();
+	_tables[name] = std::move(table);
+	return true;
+}
+
+size_t Tablebase::GetTableCount() const {
+	return _tables.size();
+}
+
+bool Tablebase::HasTable(const MaterialSignature& signature) const {
+	return _tables.find(signature.GetName()) != _tables.end();
+}
+
+bool Tablebase::Probe(const Board& board, Piece::Color player, const GameMoveData& moveData, TablebaseResult& result) const {
+	if (!_IsRegular(board, moveData)) {
+		return false;
+	}
+
+	MaterialSignature signature = MaterialSignature::Of(board);
+	if (signature.GetPieceCount() > MaterialSignature::MAX_PIECES) {
+		return false;
+	}
+
+	auto iter = _tables.find(signature.GetName());
+	if (iter == _tables.end()) {
+		return false;
+	}
+
+	return Decode(iter->second.values[signature.GetIndex(board, player)], result);
+}
+
+bool Tablebase::ProbeMove(const Board& board, Piece::Color player, const GameMoveData& moveData, const std::vector<Move>& possible, Move& move) const {
+	if (!_IsRegular(board, moveData)) {
+		return false;
+	}
+
+	// scores from the perspective of the player: wins are positive and
+	// faster wins are better, losses negative and slower losses better.
+	const Move *best = nullptr;
+	int bestScore = 0;
+
+	// the tables ignore the en passant square of a double pawn push
+	GameMoveData nextMoveData = GetRegularMoveData();
+
+	for (const Move& candidate : possible) {
+		Board next = board;
+		candidate.PerformOn(next);
+
+		TablebaseResult result;
+		if (!Probe(next, opposite(player), nextMoveData, result)) {
+			return false;
+		}
+
+		int score = 0;
+		switch (result.outcome) {
+			case TablebaseResult::Outcome::LOSS: score = 1000 - result.distance; break;
+			case TablebaseResult::Outcome::DRAW: score = 0; break;
+			case TablebaseResult::Outcome::WIN: score = -1000 + result.distance; break;
+		}
+
+		if (!best || score > bestScore) {
+			best = &candidate;
+			bestScore = score;
+		}
+	}
+
+	if (!best) {
+		return false;
+	}
+
+	move = *best;
+	return true;
+}
+
+GameMoveData Tablebase::GetRegularMoveData() {
+	GameMoveData moveData;
+	moveData.can_white_castle_king_side = false;
+	moveData.can_white_castle_queen_side = false;
+	moveData.can_black_castle_king_side = false;
+	moveData.can_black_castle_queen_side = false;
+	return moveData;
+}
+
+std::string Tablebase::GetFileName(const MaterialSignature& signature) {
+	return signature.GetName() + _EXTENSION;
+}
+
+bool Tablebase::Write(const std::string& file, const MaterialSignature& signature, const std::vector<uint8_t>& values) {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		return false;
+	}
+
+	_Header header {};
+	std::copy(_MAGIC, _MAGIC + 4, header.magic);
+	header.version = _VERSION;
+	header.piece_count = uint32_t(signature.GetPieceCount());
+
+	std::string name = signature.GetName();
+	std::copy(name.begin(), name.end(), header.name);
+
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char *>(values.data()), std::streamsize(values.size()));
+
+	return bool(out);
+}
+
+uint8_t Tablebase::EncodeWin(int distance) {
+	return uint8_t(std::min(1 + (distance - 1) / 2, _LOSS_BASE - 1));
+}
+
+uint8_t Tablebase::EncodeLoss(int distance) {
+	return uint8_t(std::min(_LOSS_BASE + distance / 2, INVALID - 1));
+}
+
+bool Tablebase::Decode(uint8_t value, TablebaseResult& result) {
+	if (value == INVALID) {
+		return false;
+	}
+
+	if (value == DRAW) {
+		result = { TablebaseResult::Outcome::DRAW, 0 };
+	} else if (value < _LOSS_BASE) {
+		result = { TablebaseResult::Outcome::WIN, 2 * (value - 1) + 1 };
+	} else {
+		result = { TablebaseResult::Outcome::LOSS, 2 * (value - _LOSS_BASE) };
+	}
+
+	return true;
+}
+
+bool Tablebase::_IsRegular(const Board& board, const GameMoveData& moveData) {
+	if (moveData.en_passant_position.IsValid()) {
+		return false;
+	}
+
+	// castling rights only matter while the king and the rook are at home
+	const auto canCastle = [&board](bool right, const char *king, const char *rook, Piece piece, Piece rookPiece) {
+		return right && board[king] == piece && board[rook] == rookPiece;
+	};
+
+	Piece whiteKing(Piece::Type::KING, Piece::Type::NONE);
+	Piece whiteRook(Piece::Type::ROOK, Piece::Type::NONE);
+	Piece blackKing(Piece::Type::NONE, Piece::Type::KING);
+	Piece blackRook(Piece::Type::NONE, Piece::Type::ROOK);
+
+	return !canCastle(moveData.can_white_castle_king_side, "e1", "h1", whiteKing, whiteRook) &&
+			!canCastle(moveData.can_white_castle_queen_side, "e1", "a1", whiteKing, whiteRook) &&
+			!canCastle(moveData.can_black_castle_king_side, "e8", "h8", blackKing, blackRook) &&
+			!canCastle(moveData.can_black_castle_queen_side, "e8", "a8", blackKing, blackRook);
+}
+
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef TABLEBASE_H_
+#define TABLEBASE_H_
+
+#include "Board.h"
+#include "GameMoveData.h"
+#include "MappedFile.h"
+#include "MaterialSignature.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ps {
+
+struct TablebaseResult {
+	enum class Outcome {
+		LOSS, DRAW, WIN
+	};
+
+	// the outcome for the player to move
+	Outcome outcome = Outcome::DRAW;
+
+	// the number of plies to mate, for wins and losses
+	int distance = 0;
+};
+
+/**
+ * Endgame tables with the win, draw or loss and the distance to mate of every
+ * position of a material signature. There is one file per signature, with one
+ * byte per position index, and the files are memory mapped.
+ *
+ * The tables contain positions without castling rights or en passant moves.
+ */
+class Tablebase {
+
+public:
+	/**
+	 * Maps all tables in the directory.
+	 */
+	bool Open(const std::string& directory);
+
+	/**
+	 * Maps a single table file.
+	 */
+	bool Add(const std::string& file);
+
+	size_t GetTableCount() const;
+	bool HasTable(const MaterialSignature& signature) const;
+
+	bool Probe(const Board& board, Piece::Color player, const GameMoveData& moveData, TablebaseResult& result) const;
+
+	/**
+	 * Picks the best move: the fastest win, otherwise a draw, otherwise the
+	 * slowest loss. Returns false if not all moves could be probed.
+	 */
+	bool ProbeMove(const Board& board, Piece::Color player, const GameMoveData& moveData, const std::vector<Move>& possible, Move& move) const;
+
+	/**
+	 * Returns move data without castling rights or en passant, as assumed by
+	 * the tables.
+	 */
+	static GameMoveData GetRegularMoveData();
+
+	static std::string GetFileName(const MaterialSignature& signature);
+	static bool Write(const std::string& file, const MaterialSignature& signature, const std::vector<uint8_t>& values);
+
+	static uint8_t EncodeWin(int distance);
+	static uint8_t EncodeLoss(int distance);
+	static bool Decode(uint8_t value, TablebaseResult& result);
+
+public:
+	// the value of drawn positions, and of unresolved positions during
+	// generation.
+	static constexpr uint8_t DRAW = 0;
+
+	// the value of indices that are not a legal position.
+	static constexpr uint8_t INVALID = 255;
+
+private:
+	struct _Table {
+		MaterialSignature signature;
+		MappedFile file;
+		const uint8_t *values = nullptr;
+	};
+
+	struct _Header {
+		char magic[4];
+		uint32_t version;
+		uint32_t piece_count;
+		uint32_t reserved;
+		char name[16];
+	};
+
+	static bool _IsRegular(const Board& board, const GameMoveData& moveData);
+
+	std::unordered_map<std::string, _Table> _tables;
+
+private:
+	static constexpr char _MAGIC[4] = { 'P', 'S', 'T', 'B' };
+	static constexpr uint32_t _VERSION = 1;
+	static constexpr auto _EXTENSION = ".pstb";
+
+	// wins are stored as 1 + (distance - 1) / 2 up to _LOSS_BASE - 1, losses as
+	// _LOSS_BASE + distance / 2 up to INVALID - 1.
+	static constexpr uint8_t _LOSS_BASE = 128;
+
+};
+
+}
+
+#endif
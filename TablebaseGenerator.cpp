@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "TablebaseGenerator.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace ps {
+
+TablebaseGenerator::TablebaseGenerator(const std::string& directory, size_t threadCount) :
+		_directory(directory),
+		_thread_pool(threadCount) {}
+
+bool TablebaseGenerator::Generate(const MaterialSignature& signature) {
+	std::string file = (std::filesystem::path(_directory) / Tablebase::GetFileName(signature)).string();
+
+	if (_tablebase.HasTable(signature) || _tablebase.Add(file)) {
+		return true;
+	}
+
+	for (const MaterialSignature& promotion : signature.GetPromotions()) {
+		if (!Generate(promotion)) {
+			return false;
+		}
+	}
+
+	return _Generate(signature) && _tablebase.Add(file);
+}
+
+bool TablebaseGenerator::_Generate(const MaterialSignature& signature) {
+	auto start = std::chrono::steady_clock::now();
+
+	size_t count = signature.GetPositionCount();
+	std::vector<uint8_t> values(count);
+
+	_ForEachChunk(count, [&](size_t begin, size_t end) {
+		_Initialize(signature, values, begin, end);
+		return size_t(0);
+	});
+
+	// the chunks write disjoint ranges of the next values.
+	std::vector<uint8_t> next = values;
+	int passes = 0;
+	size_t changed;
+
+	do {
+		changed = _ForEachChunk(count, [&](size_t begin, size_t end) {
+			return _Iterate(signature, values, next, begin, end);
+		});
+		values = next;
+		passes++;
+	} while (changed > 0);
+
+	auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	std::cout << signature.GetName() << ": " << count << " positions, " << passes << " passes, " << time.count() << " ms" << std::endl;
+
+	std::string file = (std::filesystem::path(_directory) / Tablebase::GetFileName(signature)).string();
+	return Tablebase::Write(file, signature, values);
+}
+
+void TablebaseGenerator::_Initialize(const MaterialSignature& signature, std::vector<uint8_t>& values, size_t begin, size_t end) const {
+	GameMoveData moveData = Tablebase::GetRegularMoveData();
+	Board board;
+	Piece::Color player;
+
+	for (size_t index = begin; index < end; index++) {
+		uint8_t value = Tablebase::DRAW;
+
+		// the side that just moved can not be in sako.
+		if (!signature.SetupBoard(index, board, player) || board.IsSako(opposite(player), moveData)) {
+			value = Tablebase::INVALID;
+		} else if (board.GetAllPossibleMoves(player, moveData).empty() && board.IsSako(player, moveData)) {
+			value = Tablebase::EncodeLoss(0);
+		}
+
+		values[index] = value;
+	}
+}
+
+size_t TablebaseGenerator::_Iterate(const MaterialSignature& signature, const std::vector<uint8_t>& values, std::vector<uint8_t>& next, size_t begin, size_t end) const {
+	Board board;
+	Piece::Color player;
+	size_t changed = 0;
+
+	for (size_t index = begin; index < end; index++) {
+		if (values[index] != Tablebase::DRAW) {
+			continue;
+		}
+
+		signature.SetupBoard(index, board, player);
+
+		uint8_t value = _Evaluate(signature, values, board, player);
+		if (value != Tablebase::DRAW) {
+			next[index] = value;
+			changed++;
+		}
+	}
+
+	return changed;
+}
+
+uint8_t TablebaseGenerator::_Evaluate(const MaterialSignature& signature, const std::vector<uint8_t>& values, const Board& board, Piece::Color player) const {
+	GameMoveData moveData = Tablebase::GetRegularMoveData();
+	std::vector<Move> moves = board.GetAllPossibleMoves(player, moveData);
+
+	if (moves.empty()) {
+		return Tablebase::DRAW;
+	}
+
+	bool hasPawns = std::count(signature.GetWhitePieces().begin(), signature.GetWhitePieces().end(), Piece::Type::PAWN) > 0 ||
+			std::count(signature.GetBlackPieces().begin(), signature.GetBlackPieces().end(), Piece::Type::PAWN) > 0;
+
+	int fastestWin = -1;
+	int slowestLoss = -1;
+	bool allLost = true;
+
+	for (const Move& move : moves) {
+		Board next = board;
+		move.PerformOn(next);
+
+		TablebaseResult result;
+		bool known;
+
+		if (!hasPawns || MaterialSignature::Of(next) == signature) {
+			known = Tablebase::Decode(values[signature.GetIndex(next, opposite(player))], result);
+		} else {
+			known = _tablebase.Probe(next, opposite(player), moveData, result);
+		}
+
+		// unresolved successors are stored as draws
+		if (!known || result.outcome == TablebaseResult::Outcome::DRAW) {
+			allLost = false;
+		} else if (result.outcome == TablebaseResult::Outcome::LOSS) {
+			if (fastestWin < 0 || result.distance + 1 < fastestWin) {
+				fastestWin = result.distance + 1;
+			}
+		} else {
+			slowestLoss = std::max(slowestLoss, result.distance + 1);
+		}
+	}
+
+	if (fastestWin >= 0) {
+		return Tablebase::EncodeWin(fastestWin);
+	}
+
+	if (allLost) {
+		return Tablebase::EncodeLoss(slowestLoss);
+	}
+
+	return Tablebase::DRAW;
+}
+
+template<typename F>
+size_t TablebaseGenerator::_ForEachChunk(size_t count, F function) {
+	std::vector<std::future<size_t>> chunks;
+
+	for (size_t begin = 0; begin < count; begin += _CHUNK_SIZE) {
+		size_t end = std::min(begin + _CHUNK_SIZE, count);
+		chunks.push_back(_thread_pool.Submit([&function, begin, end]() {
+			return function(begin, end);
+		}));
+	}
+
+	size_t total = 0;
+	for (auto& chunk : chunks) {
+		total += chunk.get();
+	}
+
+	return total;
+}
+
+}
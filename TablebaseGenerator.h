@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef TABLEBASEGENERATOR_H_
+#define TABLEBASEGENERATOR_H_
+
+#include "MaterialSignature.h"
+#include "Tablebase.h"
+#include "ThreadPool.h"
+
+#include <string>
+#include <vector>
+
+namespace ps {
+
+/**
+ * Generates tablebase files by retrograde analysis. All positions of a
+ * signature are first scored as mate, stalemate or invalid, after which
+ * repeated passes over the unresolved positions propagate wins and losses
+ * from their successors until a pass changes nothing. Each pass reads the
+ * results of the previous pass only, so pass n resolves exactly the positions
+ * that are decided in n plies, and the distances are minimal. The passes are
+ * split into chunks of indices that are evaluated on a thread pool.
+ *
+ * Successors after a promotion belong to another signature, whose table is
+ * generated first and probed from disk. Castling and en passant are not part
+ * of the tables, which is exact for all positions where they are not
+ * available.
+ */
+class TablebaseGenerator {
+
+public:
+	TablebaseGenerator(const std::string& directory, size_t threadCount = std::thread::hardware_concurrency());
+
+	/**
+	 * Generates the table of the signature, and the tables of the signatures
+	 * it promotes to. Tables that already exist in the directory are kept.
+	 */
+	bool Generate(const MaterialSignature& signature);
+
+private:
+	bool _Generate(const MaterialSignature& signature);
+
+	void _Initialize(const MaterialSignature& signature, std::vector<uint8_t>& values, size_t begin, size_t end) const;
+	size_t _Iterate(const MaterialSignature& signature, const std::vector<uint8_t>& values, std::vector<uint8_t>& next, size_t begin, size_t end) const;
+	uint8_t _Evaluate(const MaterialSignature& signature, const std::vector<uint8_t>& values, const Board& board, Piece::Color player) const;
+
+	template<typename F>
+	size_t _ForEachChunk(size_t count, F function);
+
+	std::string _directory;
+	ThreadPool _thread_pool;
+	Tablebase _tablebase;
+
+private:
+	static constexpr size_t _CHUNK_SIZE = 1 << 14;
+
+};
+
+}
+
+#endif
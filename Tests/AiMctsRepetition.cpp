@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../AiMcts.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool play(ps::Game& game, const std::vector<std::string>& names) {
+	for (const std::string& name : names) {
+		auto possible = game.GetBoard().GetAllPossibleMoves(game.GetPlayerColor(), game.GetMoveData());
+		auto found = std::find_if(possible.begin(), possible.end(), [&name](const ps::Move& move) {
+			return move.GetName() == name;
+		});
+
+		if (found == possible.end()) {
+			std::cerr << "illegal move " << name << std::endl;
+			return false;
+		}
+
+		game.MakeMove(*found);
+	}
+
+	return true;
+}
+
+static bool search(ps::AiMcts& player, const ps::Game& game, ps::Move& move) {
+	auto possible = game.GetBoard().GetAllPossibleMoves(game.GetPlayerColor(), game.GetMoveData());
+	std::atomic_bool stop { false };
+
+	player.SetPositionHistory(&game.GetHistory());
+	move = player.MakeMove(game.GetBoard(), game.GetMoveData(), possible, stop);
+
+	return std::find(possible.begin(), possible.end(), move) != possible.end();
+}
+
+/**
+ * Searches a position, and then the position that repeats it two plies
+ * later. The search tree of the first position scores the repetition as a
+ * draw, so the second search must not reuse that node as its root without
+ * giving it moves.
+ */
+int main() {
+	ps::AiMcts player(ps::Piece::Color::WHITE, std::chrono::milliseconds(60000), 3000, 2);
+	player.SetStatisticsSink(nullptr);
+
+	ps::Game first;
+	ps::Move move;
+
+	if (!play(first, { "g1f3", "g8f6" }) || !search(player, first, move)) {
+		std::cerr << "the first search failed" << std::endl;
+		return 1;
+	}
+
+	ps::Game repeated;
+	player.SetMaxPlayouts(0);
+	player.SetMoveTime(std::chrono::milliseconds(500));
+
+	if (!play(repeated, { "g1f3", "g8f6", "f3g1", "f6g8" }) || !search(player, repeated, move)) {
+		std::cerr << "the search of the repeated position failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "ok " << move.GetName() << std::endl;
+	return 0;
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "TexelTuner.h"
+
+#include "SampleShard.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <iomanip>
+
+namespace ps {
+
+TexelTuner::TexelTuner(const TexelSettings& settings) :
+		_settings(settings) {
+
+	_settings.threads = std::max<size_t>(_settings.threads, 1);
+}
+
+bool TexelTuner::AddShard(const std::string& file) {
+	std::vector<PositionSample> samples;
+	if (!SampleShardReader::Read(file, samples)) {
+		return false;
+	}
+
+	for (const PositionSample& sample : samples) {
+		if (!Add(sample.position, 0.5f + 0.5f * float(sample.result))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TexelTuner::AddOutcomes(const std::string& file) {
+	std::ifstream in(file, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	PositionOutcomes outcomes;
+	while (in.read(reinterpret_cast<char *>(&outcomes), sizeof(outcomes))) {
+		if (outcomes.count > 0) {
+			float result = (float(outcomes.white_wins) + 0.5f * float(outcomes.draws)) / float(outcomes.count);
+			if (!Add(outcomes.position, result, float(outcomes.count))) {
+				return false;
+			}
+		}
+	}
+
+	return in.eof() && in.gcount() == 0;
+}
+
+bool TexelTuner::Add(const PackedPosition& position, float result, float weight) {
+	// the features are decoded from the packed position directly, without
+	// building a board. The coefficients are collected densely, since a
+	// position touches only a few dozen of them.
+	std::array<int, PARAMETER_COUNT> coefficients {};
+	std::array<bool, PARAMETER_COUNT> isTouched {};
+	std::array<uint16_t, 3 * 64> touched;
+	size_t touchedCount = 0;
+
+	auto add = [&](int parameter, int sign) {
+		if (!isTouched[parameter]) {
+			isTouched[parameter] = true;
+			touched[touchedCount++] = uint16_t(parameter);
+		}
+
+		coefficients[parameter] += sign;
+	};
+
+	auto addHalf = [&](int side, int type, int row, int column, bool inUnion) {
+		int square = side == 0 ? (7 - row) * 8 + column : row * 8 + column;
+		int sign = side == 0 ? 1 : -1;
+
+		add(_MATERIAL + type, sign);
+		add(_PSQ + type * 64 + square, sign);
+
+		if (inUnion) {
+			add(_UNION + type, sign);
+		}
+	};
+
+	uint64_t occupancy = 0;
+	for (int i = 7; i >= 0; i--) {
+		occupancy = (occupancy << 8) | position.data[i];
+	}
+
+	int nibble = 0;
+	auto next = [&position, &nibble]() {
+		int value = (position.data[8 + nibble / 2] >> (4 * (nibble % 2))) & 0xF;
+		nibble++;
+		return value;
+	};
+
+	for (int square = 0; square < 64; square++) {
+		if (!(occupancy & (uint64_t(1) << square))) {
+			continue;
+		}
+
+		if (nibble >= 32) {
+			return false;
+		}
+
+		int row = square / 8;
+		int column = square % 8;
+		int code = next();
+
+		if (code < 6) {
+			addHalf(0, code + 1, row, column, false);
+		} else if (code < 12) {
+			addHalf(1, code - 6 + 1, row, column, false);
+		} else {
+			int combination = nibble < 32 ? (code - 12) * 16 + next() : 36;
+			if (combination >= 36) {
+				return false;
+			}
+
+			addHalf(0, combination / 6 + 1, row, column, true);
+			addHalf(1, combination % 6 + 1, row, column, true);
+		}
+	}
+
+	for (size_t i = 0; i < touchedCount; i++) {
+		int parameter = touched[i];
+
+		if (coefficients[parameter] != 0 && _IsTunable(parameter)) {
+			_parameters.push_back(uint16_t(parameter));
+			_coefficients.push_back(int8_t(coefficients[parameter]));
+		}
+	}
+
+	_offsets.push_back(uint32_t(_parameters.size()));
+	_results.push_back(result);
+	_weights.push_back(weight);
+	_weight_sum += weight;
+	return true;
+}
+
+size_t TexelTuner::GetSize() const {
+	return _results.size();
+}
+
+double TexelTuner::FitScale(const Evaluator::Weights& weights) {
+	Parameters parameters = ToParameters(weights);
+
+	// the loss is convex enough in the scale for a ternary search
+	double low = 0.05;
+	double high = 5.0;
+
+	for (int i = 0; i < 40; i++) {
+		double a = low + (high - low) / 3.0;
+		double b = high - (high - low) / 3.0;
+
+		if (_Loss(parameters, a, nullptr) < _Loss(parameters, b, nullptr)) {
+			high = b;
+		} else {
+			low = a;
+		}
+	}
+
+	_scale = (low + high) / 2.0;
+	return _scale;
+}
+
+double TexelTuner::GetScale() const {
+	return _scale;
+}
+
+double TexelTuner::GetLoss(const Evaluator::Weights& weights) const {
+	return _Loss(ToParameters(weights), _scale, nullptr);
+}
+
+void TexelTuner::Tune(Evaluator::Weights& weights, const std::function<void(int, double)>& callback) {
+	constexpr double beta1 = 0.9;
+	constexpr double beta2 = 0.999;
+	constexpr double epsilon = 1e-8;
+
+	Parameters parameters = ToParameters(weights);
+	Parameters gradient(PARAMETER_COUNT);
+	Parameters m(PARAMETER_COUNT, 0.0);
+	Parameters v(PARAMETER_COUNT, 0.0);
+
+	for (int epoch = 1; epoch <= _settings.epochs; epoch++) {
+		double loss = _Loss(parameters, _scale, &gradient);
+
+		double correction1 = 1.0 - std::pow(beta1, epoch);
+		double correction2 = 1.0 - std::pow(beta2, epoch);
+
+		for (int i = 0; i < PARAMETER_COUNT; i++) {
+			m[i] = beta1 * m[i] + (1.0 - beta1) * gradient[i];
+			v[i] = beta2 * v[i] + (1.0 - beta2) * gradient[i] * gradient[i];
+			parameters[i] -= _settings.learning_rate * (m[i] / correction1) / (std::sqrt(v[i] / correction2) + epsilon);
+		}
+
+		if (callback) {
+			callback(epoch, loss);
+		}
+	}
+
+	weights = FromParameters(parameters);
+}
+
+TexelTuner::Parameters TexelTuner::ToParameters(const Evaluator::Weights& weights) {
+	Parameters parameters(PARAMETER_COUNT);
+
+	for (int t = 0; t < 7; t++) {
+		parameters[_MATERIAL + t] = weights.material[t];
+		parameters[_UNION + t] = weights.union_half[t];
+
+		for (int s = 0; s < 64; s++) {
+			parameters[_PSQ + t * 64 + s] = weights.psq[t][s];
+		}
+	}
+
+	return parameters;
+}
+
+Evaluator::Weights TexelTuner::FromParameters(const Parameters& parameters) {
+	Evaluator::Weights weights {};
+
+	for (int t = 0; t < 7; t++) {
+		weights.material[t] = int(std::lround(parameters[_MATERIAL + t]));
+		weights.union_half[t] = int(std::lround(parameters[_UNION + t]));
+
+		for (int s = 0; s < 64; s++) {
+			weights.psq[t][s] = int(std::lround(parameters[_PSQ + t * 64 + s]));
+		}
+	}
+
+	return weights;
+}
+
+void TexelTuner::WriteWeights(const Evaluator::Weights& weights, std::ostream& out) {
+	static const char *names[7] = { "none", "pawn", "rook", "knight", "bishop", "queen", "king" };
+
+	auto writeTypes = [&out](const std::array<int, 7>& values) {
+		out << "\t{ ";
+		for (int t = 0; t < 7; t++) {
+			out << values[t] << (t < 6 ? ", " : " }");
+		}
+	};
+
+	out << "\t// material\n";
+	writeTypes(weights.material);
+	out << ",\n\n\t// piece-square tables\n\t{ {\n\t\t// none\n\t\t{},\n";
+
+	for (int t = 1; t < 7; t++) {
+		out << "\n\t\t// " << names[t] << "\n\t\t{\n";
+
+		for (int r = 0; r < 8; r++) {
+			out << "\t\t\t";
+
+			for (int c = 0; c < 8; c++) {
+				out << std::setw(3) << weights.psq[t][r * 8 + c] << (r * 8 + c < 63 ? "," : "") << (c < 7 ? " " : "");
+			}
+
+			out << "\n";
+		}
+
+		out << "\t\t}" << (t < 6 ? "," : "") << "\n";
+	}
+
+	out << "\t} },\n\n\t// union halves\n";
+	writeTypes(weights.union_half);
+	out << "\n";
+}
+
+double TexelTuner::_Evaluate(size_t index, const Parameters& parameters) const {
+	double evaluation = 0.0;
+
+	for (uint32_t i = _offsets[index]; i < _offsets[index + 1]; i++) {
+		evaluation += _coefficients[i] * parameters[_parameters[i]];
+	}
+
+	return evaluation;
+}
+
+double TexelTuner::_Loss(const Parameters& parameters, double scale, Parameters *gradient) const {
+	if (_results.empty()) {
+		return 0.0;
+	}
+
+	// the sigmoid of the usual Texel form, 1 / (1 + 10^(-scale * eval / 400))
+	const double factor = scale * std::log(10.0) / 400.0;
+
+	struct Partial {
+		double loss = 0.0;
+		Parameters gradient;
+	};
+
+	ThreadPool pool(std::min(_settings.threads, (_results.size() + _CHUNK_SIZE - 1) / _CHUNK_SIZE));
+	std::vector<std::future<Partial>> futures;
+
+	// every task sums the loss and the gradient of a strided set of chunks
+	size_t taskCount = pool.GetThreadCount();
+
+	for (size_t task = 0; task < taskCount; task++) {
+		futures.push_back(pool.Submit([this, task, taskCount, factor, &parameters, gradient]() {
+			Partial partial;
+			if (gradient) {
+				partial.gradient.assign(PARAMETER_COUNT, 0.0);
+			}
+
+			for (size_t start = task * _CHUNK_SIZE; start < _results.size(); start += taskCount * _CHUNK_SIZE) {
+				size_t end = std::min(start + _CHUNK_SIZE, _results.size());
+
+				for (size_t i = start; i < end; i++) {
+					double sigmoid = 1.0 / (1.0 + std::exp(-factor * _Evaluate(i, parameters)));
+					double error = _results[i] - sigmoid;
+
+					partial.loss += _weights[i] * error * error;
+
+					if (gradient) {
+						double derivative = -2.0 * _weights[i] * error * sigmoid * (1.0 - sigmoid) * factor;
+
+						for (uint32_t j = _offsets[i]; j < _offsets[i + 1]; j++) {
+							partial.gradient[_parameters[j]] += derivative * _coefficients[j];
+						}
+					}
+				}
+			}
+
+			return partial;
+		}));
+	}
+
+	double loss = 0.0;
+
+	if (gradient) {
+		gradient->assign(PARAMETER_COUNT, 0.0);
+	}
+
+	for (auto& future : futures) {
+		Partial partial = future.get();
+		loss += partial.loss;
+
+		if (gradient) {
+			for (int i = 0; i < PARAMETER_COUNT; i++) {
+				(*gradient)[i] += partial.gradient[i] / _weight_sum;
+			}
+		}
+	}
+
+	return loss / _weight_sum;
+}
+
+bool TexelTuner::_IsTunable(int parameter) {
+	// nothing is of type none, and both sides always have one king, so the
+	// material of the kings cancels out.
+	if (parameter >= _PSQ && parameter < _UNION) {
+		return (parameter - _PSQ) / 64 != 0;
+	}
+
+	int type = parameter >= _UNION ? parameter - _UNION : parameter - _MATERIAL;
+	return type != 0 && !(parameter < _PSQ && type == int(Piece::Type::KING));
+}
+
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef TEXELTUNER_H_
+#define TEXELTUNER_H_
+
+#include "Evaluator.h"
+#include "PositionSample.h"
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ps {
+
+struct TexelSettings {
+	size_t threads = std::thread::hardware_concurrency();
+	int epochs = 100;
+
+	// the step size of the Adam optimizer, in centipawns.
+	double learning_rate = 1.0;
+};
+
+/**
+ * Tunes the evaluation weights to predict game results. The evaluation is
+ * linear in the weights, so every position is stored as the sparse vector of
+ * how often each weight counts for white minus for black. The vectors are
+ * kept as one array of weight indices and one of coefficients for all
+ * positions, with the results and the sample weights in arrays of their own.
+ *
+ * The loss is the mean squared difference between the result (1, 0.5 or 0
+ * from the white side) and the sigmoid of the evaluation. Its gradient is
+ * summed over chunks of positions in parallel, and the weights are updated
+ * with Adam once per epoch.
+ */
+class TexelTuner {
+
+public:
+	// material, piece-square tables and union halves, indexed by type
+	static constexpr int PARAMETER_COUNT = 7 + 7 * 64 + 7;
+
+	using Parameters = std::vector<double>;
+
+public:
+	TexelTuner(const TexelSettings& settings);
+
+	/**
+	 * Adds the samples of a shard, or the positions of a file of position
+	 * outcomes, weighted by how often they occurred.
+	 */
+	bool AddShard(const std::string& file);
+	bool AddOutcomes(const std::string& file);
+
+	/**
+	 * Adds a position with its result from the white side. Returns false if the
+	 * position is not a valid packed position.
+	 */
+	bool Add(const PackedPosition& position, float result, float weight = 1.0f);
+
+	size_t GetSize() const;
+
+	/**
+	 * Finds the scale of the sigmoid that fits the weights best, which is then
+	 * kept fixed while tuning.
+	 */
+	double FitScale(const Evaluator::Weights& weights);
+	double GetScale() const;
+
+	double GetLoss(const Evaluator::Weights& weights) const;
+
+	/**
+	 * Tunes the weights. The callback, if any, receives the loss after every
+	 * epoch.
+	 */
+	void Tune(Evaluator::Weights& weights, const std::function<void(int, double)>& callback = nullptr);
+
+	static Parameters ToParameters(const Evaluator::Weights& weights);
+	static Evaluator::Weights FromParameters(const Parameters& parameters);
+
+	/**
+	 * Writes the weights as an initializer in the layout of
+	 * Evaluator::DEFAULT_WEIGHTS.
+	 */
+	static void WriteWeights(const Evaluator::Weights& weights, std::ostream& out);
+
+private:
+	double _Evaluate(size_t index, const Parameters& parameters) const;
+	double _Loss(const Parameters& parameters, double scale, Parameters *gradient) const;
+
+	static bool _IsTunable(int parameter);
+
+	TexelSettings _settings;
+	double _scale = 1.0;
+
+	// position i has the coefficients _offsets[i] to _offsets[i + 1]
+	std::vector<uint32_t> _offsets { 0 };
+	std::vector<uint16_t> _parameters;
+	std::vector<int8_t> _coefficients;
+
+	std::vector<float> _results;
+	std::vector<float> _weights;
+	double _weight_sum = 0.0;
+
+private:
+	static constexpr int _MATERIAL = 0;
+	static constexpr int _PSQ = 7;
+	static constexpr int _UNION = 7 + 7 * 64;
+
+	static constexpr size_t _CHUNK_SIZE = 1 << 14;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "ThreadPool.h"
+
+namespace ps {
+
+ThreadPool::ThreadPool(size_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = 1;
+	}
+
+	for (size_t i = 0; i < threadCount; i++) {
+		_threads.emplace_back(&ThreadPool::_WorkerMain, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(_mutex);
+		_stop = true;
+	}
+
+	_condition.notify_all();
+
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+}
+
+size_t ThreadPool::GetThreadCount() const {
+	return _threads.size();
+}
+
+void ThreadPool::_Push(std::function<void()> task) {
+	{
+		std::lock_guard lock(_mutex);
+		_tasks.push(std::move(task));
+	}
+
+	_condition.notify_one();
+}
+
+void ThreadPool::_WorkerMain() {
+	while (true) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock lock(_mutex);
+			_condition.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+			// finish the queued tasks before stopping
+			if (_tasks.empty()) {
+				return;
+			}
+
+			task = std::move(_tasks.front());
+			_tasks.pop();
+		}
+
+		task();
+	}
+}
+
+}
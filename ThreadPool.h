@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace ps {
+
+/**
+ * A fixed set of worker threads that execute submitted tasks in order.
+ */
+class ThreadPool {
+
+public:
+	ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	size_t GetThreadCount() const;
+
+	/**
+	 * Queues the task for execution on one of the worker threads. The returned
+	 * future becomes ready when the task has finished.
+	 */
+	template<typename F>
+	auto Submit(F&& task) -> std::future<decltype(task())> {
+		using Result = decltype(task());
+
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		std::future<Result> future = packaged->get_future();
+
+		_Push([packaged]() {
+			(*packaged)();
+		});
+
+		return future;
+	}
+
+private:
+	void _Push(std::function<void()> task);
+	void _WorkerMain();
+
+	std::vector<std::thread> _threads;
+
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::queue<std::function<void()>> _tasks;
+	bool _stop = false;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "TimeManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ps {
+
+void TimeManager::Start(std::chrono::milliseconds moveTime) {
+	_start = std::chrono::steady_clock::now();
+	_soft_limit = moveTime;
+	_hard_limit = moveTime;
+	_adjust = false;
+	_stability_factor = 1.0;
+}
+
+void TimeManager::Start(const Clock& clock, Piece::Color color, size_t legalMoves) {
+	_start = std::chrono::steady_clock::now();
+	_adjust = true;
+	_stability_factor = 1.0;
+
+	Clock::Duration remaining = clock.GetRemaining(color) - _OVERHEAD;
+	Clock::Duration increment = clock.GetTimeControl().increment;
+
+	if (remaining <= Clock::Duration::zero()) {
+		_soft_limit = Clock::Duration::zero();
+		_hard_limit = Clock::Duration::zero();
+		return;
+	}
+
+	Clock::Duration base = remaining / _MOVES_TO_GO + increment * 3 / 4;
+
+	// positions with few legal moves need less thought: a factor of 0.4 for
+	// two moves up to 1.2 for sixty-four moves.
+	double legalFactor = std::clamp(std::log2(double(std::max<size_t>(legalMoves, 1))) / 5.0, 0.4, 1.2);
+
+	// the increment is only added after the move, so a search never spends
+	// more than half of the time that is left now. The soft limit is stretched
+	// by the stability factor, and clamped to the hard limit after that.
+	_soft_limit = std::chrono::duration_cast<Clock::Duration>(base * legalFactor);
+	_hard_limit = std::min({
+			std::chrono::duration_cast<Clock::Duration>(_soft_limit * _HARD_FACTOR),
+			remaining / 4 + increment,
+			remaining / _MAX_SHARE });
+	_soft_limit = std::min(_soft_limit, _hard_limit);
+}
+
+void TimeManager::Update(bool bestMoveChanged) {
+	if (bestMoveChanged) {
+		_stability_factor = std::min(_stability_factor * _UNSTABLE_FACTOR, _MAX_STABILITY_FACTOR);
+	} else {
+		_stability_factor = std::max(_stability_factor * _STABLE_FACTOR, _MIN_STABILITY_FACTOR);
+	}
+}
+
+bool TimeManager::IsSoftLimitReached() const {
+	return std::chrono::steady_clock::now() - _start >= GetSoftLimit();
+}
+
+TimeManager::TimePoint TimeManager::GetHardDeadline() const {
+	return _start + _hard_limit;
+}
+
+Clock::Duration TimeManager::GetSoftLimit() const {
+	if (!_adjust) {
+		return _soft_limit;
+	}
+
+	auto soft = std::chrono::duration_cast<Clock::Duration>(_soft_limit * _stability_factor);
+	return std::min(soft, _hard_limit);
+}
+
+Clock::Duration TimeManager::GetHardLimit() const {
+	return _hard_limit;
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef TIMEMANAGER_H_
+#define TIMEMANAGER_H_
+
+#include "Clock.h"
+
+#include <chrono>
+
+namespace ps {
+
+/**
+ * Budgets the time of a single search. The soft limit is the time the search
+ * aims for, and is stretched while the best move keeps changing and shrunk
+ * while it is stable. The hard limit is never exceeded, and never more than
+ * half of the time left on the clock.
+ */
+class TimeManager {
+
+public:
+	using TimePoint = std::chrono::steady_clock::time_point;
+
+public:
+	/**
+	 * Starts a search with a fixed time, without adjusting for stability.
+	 */
+	void Start(std::chrono::milliseconds moveTime);
+
+	/**
+	 * Starts a search for the given player, with limits based on their time
+	 * left on the clock and the number of legal moves.
+	 */
+	void Start(const Clock& clock, Piece::Color color, size_t legalMoves);
+
+	/**
+	 * Will be called by the search periodically, with whether the best move
+	 * changed since the previous update.
+	 */
+	void Update(bool bestMoveChanged);
+
+	bool IsSoftLimitReached() const;
+	TimePoint GetHardDeadline() const;
+
+	Clock::Duration GetSoftLimit() const;
+	Clock::Duration GetHardLimit() const;
+
+private:
+	TimePoint _start;
+	Clock::Duration _soft_limit { 0 };
+	Clock::Duration _hard_limit { 0 };
+
+	bool _adjust = false;
+	double _stability_factor = 1.0;
+
+private:
+	// the expected number of moves left in the game.
+	static constexpr int _MOVES_TO_GO = 30;
+
+	// the time kept in reserve for the overhead of the host game.
+	static constexpr std::chrono::milliseconds _OVERHEAD { 50 };
+
+	// a single search takes at most this share of the time left.
+	static constexpr int _MAX_SHARE = 2;
+
+	static constexpr double _HARD_FACTOR = 4.0;
+	static constexpr double _UNSTABLE_FACTOR = 1.4;
+	static constexpr double _STABLE_FACTOR = 0.95;
+	static constexpr double _MIN_STABILITY_FACTOR = 0.5;
+	static constexpr double _MAX_STABILITY_FACTOR = 2.5;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../AnalysisServer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * Serves analysis requests until the process is terminated, see
+ * AnalysisServer.
+ *
+ * Usage: AnalysisServer (--tcp PORT | --unix PATH) [--threads N] [--movetime MS]
+ */
+int main(int argc, char **argv) {
+	ps::AnalysisServerSettings settings;
+	int port = 0;
+	std::string path;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string argument = argv[i];
+
+		if (argument == "--tcp") {
+			port = std::atoi(argv[i + 1]);
+		} else if (argument == "--unix") {
+			path = argv[i + 1];
+		} else if (argument == "--threads") {
+			settings.threads = size_t(std::max(1, std::atoi(argv[i + 1])));
+		} else if (argument == "--movetime") {
+			settings.move_time = std::chrono::milliseconds(std::atoi(argv[i + 1]));
+		}
+	}
+
+	ps::AnalysisServer server(settings);
+
+	bool listening = !path.empty() ? server.ListenUnix(path) : port > 0 && server.ListenTcp(uint16_t(port));
+	if (!listening) {
+		std::cerr << "Usage: " << argv[0] << " (--tcp PORT | --unix PATH) [--threads N] [--movetime MS]" << std::endl;
+		return 1;
+	}
+
+	server.Run();
+	return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../BatchAnalyzer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/**
+ * Analyses PsFEN lines from a file or stdin and writes NDJSON to stdout.
+ *
+ * Usage: Analyze [--threads N] [--movetime MS] [--playouts N] [--tablebase DIR] [file]
+ */
+int main(int argc, char **argv) {
+	std::ios::sync_with_stdio(false);
+
+	ps::BatchSettings settings;
+	ps::Tablebase tablebase;
+	std::string file;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--threads" && hasValue) {
+			settings.threads = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--movetime" && hasValue) {
+			settings.move_time = std::chrono::milliseconds(std::atoi(argv[++i]));
+		} else if (argument == "--playouts" && hasValue) {
+			settings.playouts = size_t(std::atoll(argv[++i]));
+		} else if (argument == "--tablebase" && hasValue) {
+			if (!tablebase.Open(argv[++i])) {
+				std::cerr << "Could not open the tablebase" << std::endl;
+				return 1;
+			}
+			settings.tablebase = &tablebase;
+		} else {
+			file = argument;
+		}
+	}
+
+	ps::BatchAnalyzer analyzer(settings);
+
+	if (file.empty()) {
+		analyzer.Run(std::cin, std::cout);
+	} else {
+		std::ifstream in(file);
+		if (!in) {
+			std::cerr << "Could not open " << file << std::endl;
+			return 1;
+		}
+
+		analyzer.Run(in, std::cout);
+	}
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../PositionDeduplicator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Deduplicates files of position samples into a file of position outcomes.
+ *
+ * Usage: DeduplicatePositions [--threads N] [--memory MB] [--temp DIR] <output> <input>...
+ */
+int main(int argc, char **argv) {
+	ps::DeduplicationSettings settings;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--threads" && hasValue) {
+			settings.threads = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--memory" && hasValue) {
+			settings.memory_budget = size_t(std::max(1, std::atoi(argv[++i]))) << 20;
+		} else if (argument == "--temp" && hasValue) {
+			settings.temp_directory = argv[++i];
+		} else {
+			files.push_back(argument);
+		}
+	}
+
+	if (files.size() < 2) {
+		std::cerr << "Usage: " << argv[0] << " [--threads N] [--memory MB] [--temp DIR] <output> <input>..." << std::endl;
+		return 1;
+	}
+
+	ps::PositionDeduplicator deduplicator(settings);
+
+	if (!deduplicator.Run({ files.begin() + 1, files.end() }, files[0])) {
+		std::cerr << "Could not deduplicate the positions" << std::endl;
+		return 1;
+	}
+
+	const ps::DeduplicationSummary& summary = deduplicator.GetSummary();
+	std::cout << summary.samples << " samples, " << summary.positions << " positions, " << summary.runs << " runs, "
+			<< summary.merge_passes << " merge passes" << std::endl;
+
+	return 0;
+}
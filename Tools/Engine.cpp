@@ -0,0 +1,31 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../Engine.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * Runs the engine protocol on stdin and stdout, see Engine.
+ */
+int main(int argc, char **argv) {
+	std::ios::sync_with_stdio(false);
+
+	size_t threadCount = std::thread::hardware_concurrency();
+	if (argc > 2 && std::string(argv[1]) == "--threads") {
+		threadCount = size_t(std::max(1, std::atoi(argv[2])));
+	}
+
+	ps::Engine engine(std::cout, threadCount);
+
+	for (std::string line; std::getline(std::cin, line);) {
+		if (!engine.Execute(line)) {
+			break;
+		}
+	}
+
+	return 0;
+}
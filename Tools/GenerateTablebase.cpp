@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../TablebaseGenerator.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Generates tablebase files.
+ *
+ * Usage: GenerateTablebase [--threads N] <directory> <signature>...
+ */
+int main(int argc, char **argv) {
+	size_t threadCount = std::thread::hardware_concurrency();
+	std::vector<std::string> arguments;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+
+		if (argument == "--threads" && i + 1 < argc) {
+			threadCount = std::max(1, std::atoi(argv[++i]));
+		} else {
+			arguments.push_back(argument);
+		}
+	}
+
+	if (arguments.size() < 2) {
+		std::cerr << "Usage: " << argv[0] << " [--threads N] <directory> <signature>..." << std::endl;
+		return 1;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(arguments[0], error);
+
+	ps::TablebaseGenerator generator(arguments[0], threadCount);
+
+	for (size_t i = 1; i < arguments.size(); i++) {
+		ps::MaterialSignature signature;
+
+		if (!ps::MaterialSignature::Parse(arguments[i], signature)) {
+			std::cerr << "Invalid signature: " << arguments[i] << std::endl;
+			return 1;
+		}
+
+		if (!generator.Generate(signature)) {
+			std::cerr << "Could not generate " << arguments[i] << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../PositionIndex.h"
+#include "../Zobrist.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static int build(const std::vector<std::string>& arguments, size_t threadCount) {
+	ps::PositionIndexer indexer(threadCount);
+
+	for (size_t i = 1; i < arguments.size(); i++) {
+		if (!indexer.AddArchive(arguments[i])) {
+			std::cerr << "Could not read " << arguments[i] << std::endl;
+			return 1;
+		}
+	}
+
+	if (!indexer.Write(arguments[0])) {
+		std::cerr << "Could not write " << arguments[0] << std::endl;
+		return 1;
+	}
+
+	std::cout << indexer.GetGameCount() << " games, " << indexer.GetSkippedCount() << " skipped, "
+			<< indexer.GetSize() << " entries" << std::endl;
+	return 0;
+}
+
+static int query(const std::vector<std::string>& arguments) {
+	ps::PositionIndex index;
+	if (!index.Open(arguments[0])) {
+		std::cerr << "Could not open " << arguments[0] << std::endl;
+		return 1;
+	}
+
+	ps::Game game;
+	ps::PsFENError error;
+
+	if (!game.SetState(arguments[1], &error)) {
+		std::cerr << "Invalid PsFEN at " << error.position << ": " << error.message << std::endl;
+		return 1;
+	}
+
+	uint64_t hash = ps::Zobrist::Hash(game.GetBoard(), game.GetPlayerColor(), game.GetMoveData());
+	auto [first, last] = index.Find(hash);
+	std::vector<ps::PositionIndexEntry> entries(first, last);
+
+	std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+		return a.games > b.games;
+	});
+
+	ps::PositionStatistics total = index.GetStatistics(hash);
+	std::cout << "games " << total.games << " white " << total.white_wins << " black " << total.black_wins
+			<< " draws " << total.draws << std::endl;
+
+	for (const ps::PositionIndexEntry& entry : entries) {
+		std::string name = entry.move == ps::PositionIndex::NO_MOVE ? "end" : ps::Move::Unpack(entry.move).GetName();
+		std::cout << name << " games " << entry.games << " white " << entry.white_wins << " black " << entry.black_wins
+				<< " draws " << entry.draws << std::endl;
+	}
+
+	return 0;
+}
+
+/**
+ * Builds and queries position indexes of game record files.
+ *
+ * Usage: PositionIndex build [--threads N] <index> <archive>...
+ *        PositionIndex query <index> <PsFEN>
+ */
+int main(int argc, char **argv) {
+	size_t threadCount = std::thread::hardware_concurrency();
+	std::vector<std::string> arguments;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+
+		if (argument == "--threads" && i + 1 < argc) {
+			threadCount = std::max(1, std::atoi(argv[++i]));
+		} else {
+			arguments.push_back(argument);
+		}
+	}
+
+	if (arguments.size() >= 3 && arguments[0] == "build") {
+		return build({ arguments.begin() + 1, arguments.end() }, threadCount);
+	} else if (arguments.size() == 3 && arguments[0] == "query") {
+		return query({ arguments.begin() + 1, arguments.end() });
+	}
+
+	std::cerr << "Usage: " << argv[0] << " build [--threads N] <index> <archive>..." << std::endl;
+	std::cerr << "       " << argv[0] << " query <index> <PsFEN>" << std::endl;
+	return 1;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../SelfPlayGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * Generates training data by self-play, as compressed sample shards.
+ *
+ * Usage: SelfPlay [--games N] [--threads N] [--movetime MS] [--playouts N]
+ *                 [--random-plies N] [--multipv N] [--margin CP]
+ *                 [--shard-size N] [--seed N] <directory>
+ */
+int main(int argc, char **argv) {
+	ps::SelfPlaySettings settings;
+	std::string directory;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--games" && hasValue) {
+			settings.games = size_t(std::atoll(argv[++i]));
+		} else if (argument == "--threads" && hasValue) {
+			settings.threads = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--movetime" && hasValue) {
+			settings.move_time = std::chrono::milliseconds(std::atoi(argv[++i]));
+		} else if (argument == "--playouts" && hasValue) {
+			settings.playouts = size_t(std::atoll(argv[++i]));
+		} else if (argument == "--random-plies" && hasValue) {
+			settings.random_plies = std::atoi(argv[++i]);
+		} else if (argument == "--multipv" && hasValue) {
+			settings.multi_pv = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--margin" && hasValue) {
+			settings.multi_pv_margin = std::atoi(argv[++i]);
+		} else if (argument == "--shard-size" && hasValue) {
+			settings.samples_per_shard = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--seed" && hasValue) {
+			settings.seed = uint64_t(std::atoll(argv[++i]));
+		} else {
+			directory = argument;
+		}
+	}
+
+	if (directory.empty()) {
+		std::cerr << "Usage: " << argv[0] << " [--games N] [--threads N] [--movetime MS] [--playouts N]"
+				<< " [--random-plies N] [--multipv N] [--margin CP] [--shard-size N] [--seed N] <directory>" << std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	ps::SelfPlayGenerator generator(settings);
+
+	if (!generator.Run(directory)) {
+		std::cerr << "Could not write the shards to " << directory << std::endl;
+		return 1;
+	}
+
+	const ps::SelfPlaySummary& summary = generator.GetSummary();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << summary.games << " games (+" << summary.white_wins << " -" << summary.black_wins << " =" << summary.draws
+			<< "), " << summary.samples << " samples, " << summary.samples / std::max(seconds, 1e-3) << " samples/s" << std::endl;
+
+	return 0;
+}
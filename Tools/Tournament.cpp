@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../AiMcts.h"
+#include "../AiRandom.h"
+#include "../Tournament.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/**
+ * Creates a player from a description like "random" or "mcts:500", where the
+ * number is the move time in milliseconds. Search players have no threads of
+ * their own and do not ponder, since the games themselves already run in
+ * parallel: every game keeps a single core busy.
+ */
+static ps::Tournament::PlayerFactory createFactory(const std::string& description, const ps::Tablebase *tablebase) {
+	size_t separator = description.find(':');
+	std::string name = description.substr(0, separator);
+	int value = separator == std::string::npos ? 0 : std::atoi(description.c_str() + separator + 1);
+
+	if (name == "random") {
+		return [](ps::Piece::Color color) {
+			return new ps::AiRandom(color, std::chrono::milliseconds(0));
+		};
+	}
+
+	if (name == "mcts") {
+		auto moveTime = std::chrono::milliseconds(value > 0 ? value : 100);
+
+		return [moveTime, tablebase](ps::Piece::Color color) {
+			auto player = new ps::AiMcts(color, moveTime, 0, 0);
+			player->SetTablebase(tablebase);
+			return player;
+		};
+	}
+
+	return nullptr;
+}
+
+/**
+ * Plays a match between two players.
+ *
+ * Usage: Tournament [options] <first> <second>
+ *   --games N          the number of games
+ *   --concurrency N    the number of games played at the same time
+ *   --openings FILE    a file with one PsFEN per line
+ *   --tc S+I           the time control in seconds plus increment
+ *   --tablebase DIR    adjudicate with the tables in the directory
+ *   --sprt E0,E1       the Elo bounds of the SPRT
+ *   --record FILE      append the games to a game record file
+ */
+int main(int argc, char **argv) {
+	ps::TournamentSettings settings;
+	ps::Tablebase tablebase;
+	std::vector<std::string> players;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--games" && hasValue) {
+			settings.games = size_t(std::atoi(argv[++i]));
+		} else if (argument == "--concurrency" && hasValue) {
+			settings.concurrency = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--openings" && hasValue) {
+			std::ifstream in(argv[++i]);
+			for (std::string line; std::getline(in, line);) {
+				if (!line.empty()) {
+					settings.openings.push_back(line);
+				}
+			}
+		} else if (argument == "--tc" && hasValue) {
+			char *end;
+			double initial = std::strtod(argv[++i], &end);
+			double increment = *end == '+' ? std::strtod(end + 1, nullptr) : 0.0;
+			settings.time_control = {
+				std::chrono::milliseconds(int64_t(initial * 1000)),
+				std::chrono::milliseconds(int64_t(increment * 1000))
+			};
+		} else if (argument == "--tablebase" && hasValue) {
+			if (!tablebase.Open(argv[++i])) {
+				std::cerr << "Could not open the tablebase" << std::endl;
+				return 1;
+			}
+			settings.tablebase = &tablebase;
+		} else if (argument == "--record" && hasValue) {
+			settings.record_file = argv[++i];
+		} else if (argument == "--sprt" && hasValue) {
+			char *end;
+			settings.elo0 = std::strtod(argv[++i], &end);
+			settings.elo1 = *end == ',' ? std::strtod(end + 1, nullptr) : settings.elo1;
+		} else {
+			players.push_back(argument);
+		}
+	}
+
+	if (players.size() != 2) {
+		std::cerr << "Usage: " << argv[0] << " [options] <first> <second>" << std::endl;
+		return 1;
+	}
+
+	settings.first_name = players[0];
+	settings.second_name = players[1];
+
+	auto first = createFactory(players[0], settings.tablebase);
+	auto second = createFactory(players[1], settings.tablebase);
+
+	if (!first || !second) {
+		std::cerr << "Unknown player, expected random or mcts[:ms]" << std::endl;
+		return 1;
+	}
+
+	ps::Tournament tournament(settings, first, second);
+	ps::TournamentScore score = tournament.Run(std::cout);
+
+	std::cout << "Score of " << players[0] << " vs " << players[1] << ": +" << score.wins
+			<< " -" << score.losses << " =" << score.draws << std::endl;
+	std::cout << "Elo difference: " << score.GetEloDifference() << " +/- " << score.GetEloError() << std::endl;
+
+	return 0;
+}
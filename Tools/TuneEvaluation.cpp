@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../TexelTuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Tunes the evaluation weights on sample shards (.pss) and files of position
+ * outcomes, starting from the default weights. The tuned weights are written
+ * in the layout of Evaluator::DEFAULT_WEIGHTS.
+ *
+ * Usage: TuneEvaluation [--threads N] [--epochs N] [--rate R] [--output FILE] <file>...
+ */
+int main(int argc, char **argv) {
+	ps::TexelSettings settings;
+	std::string output;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--threads" && hasValue) {
+			settings.threads = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--epochs" && hasValue) {
+			settings.epochs = std::max(0, std::atoi(argv[++i]));
+		} else if (argument == "--rate" && hasValue) {
+			settings.learning_rate = std::atof(argv[++i]);
+		} else if (argument == "--output" && hasValue) {
+			output = argv[++i];
+		} else {
+			files.push_back(argument);
+		}
+	}
+
+	if (files.empty()) {
+		std::cerr << "Usage: " << argv[0] << " [--threads N] [--epochs N] [--rate R] [--output FILE] <file>..." << std::endl;
+		return 1;
+	}
+
+	ps::TexelTuner tuner(settings);
+
+	for (const std::string& file : files) {
+		bool isShard = file.size() >= 4 && file.compare(file.size() - 4, 4, ".pss") == 0;
+
+		if (!(isShard ? tuner.AddShard(file) : tuner.AddOutcomes(file))) {
+			std::cerr << "Could not read " << file << std::endl;
+			return 1;
+		}
+	}
+
+	ps::Evaluator::Weights weights = ps::Evaluator::DEFAULT_WEIGHTS;
+
+	std::cout << tuner.GetSize() << " positions, scale " << tuner.FitScale(weights)
+			<< ", loss " << tuner.GetLoss(weights) << std::endl;
+
+	auto start = std::chrono::steady_clock::now();
+
+	tuner.Tune(weights, [&start](int epoch, double loss) {
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "epoch " << epoch << " loss " << loss << " (" << seconds / epoch << " s per epoch)" << std::endl;
+	});
+
+	std::cout << "final loss " << tuner.GetLoss(weights) << std::endl;
+
+	if (output.empty()) {
+		ps::TexelTuner::WriteWeights(weights, std::cout);
+	} else {
+		std::ofstream out(output);
+		ps::TexelTuner::WriteWeights(weights, out);
+
+		if (!out) {
+			std::cerr << "Could not write " << output << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "../ArchiveValidator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Replays the games of record files and reports illegal moves and final
+ * positions that do not match the record. Exits with 1 if any game is invalid
+ * or a file could not be read to the end.
+ *
+ * Usage: ValidateArchive [--threads N] [--batch N] [--verbose] <file>...
+ */
+int main(int argc, char **argv) {
+	std::ios::sync_with_stdio(false);
+
+	ps::ArchiveValidatorSettings settings;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--threads" && hasValue) {
+			settings.threads = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--batch" && hasValue) {
+			settings.batch_size = size_t(std::max(1, std::atoi(argv[++i])));
+		} else if (argument == "--verbose") {
+			settings.verbose = true;
+		} else {
+			files.push_back(argument);
+		}
+	}
+
+	if (files.empty()) {
+		std::cerr << "Usage: " << argv[0] << " [--threads N] [--batch N] [--verbose] <file>..." << std::endl;
+		return 1;
+	}
+
+	ps::ArchiveValidator validator(settings);
+	bool valid = true;
+
+	for (const std::string& file : files) {
+		std::cout << file << std::endl;
+
+		ps::ArchiveValidationSummary summary = validator.Validate(file, std::cout);
+		ps::ArchiveValidator::Write(summary, std::cout);
+
+		valid = valid && summary.complete && summary.GetInvalidCount() == 0;
+	}
+
+	return valid ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Tournament.h"
+
+#include "Evaluator.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ps {
+
+static double scoreToElo(double score) {
+	score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+	return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double eloToScore(double elo) {
+	return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+size_t TournamentScore::GetGames() const {
+	return wins + losses + draws;
+}
+
+double TournamentScore::GetScore() const {
+	size_t games = GetGames();
+	return games == 0 ? 0.5 : (wins + 0.5 * draws) / games;
+}
+
+double TournamentScore::GetEloDifference() const {
+	return scoreToElo(GetScore());
+}
+
+double TournamentScore::GetEloError() const {
+	size_t games = GetGames();
+	if (games == 0) {
+		return 0.0;
+	}
+
+	double score = GetScore();
+	double variance = (wins * std::pow(1.0 - score, 2) + losses * std::pow(score, 2) +
+			draws * std::pow(0.5 - score, 2)) / games;
+	double margin = 1.96 * std::sqrt(variance / games);
+
+	return (scoreToElo(score + margin) - scoreToElo(score - margin)) / 2.0;
+}
+
+double TournamentScore::GetLogLikelihoodRatio(double elo0, double elo1) const {
+	size_t games = GetGames();
+	if (games == 0) {
+		return 0.0;
+	}
+
+	double score = GetScore();
+	double variance = (wins * std::pow(1.0 - score, 2) + losses * std::pow(score, 2) +
+			draws * std::pow(0.5 - score, 2)) / games;
+
+	if (variance <= 0.0) {
+		return 0.0;
+	}
+
+	double score0 = eloToScore(elo0);
+	double score1 = eloToScore(elo1);
+
+	return games * (score1 - score0) * (2.0 * score - score0 - score1) / (2.0 * variance);
+}
+
+Tournament::_Adjudicator::_Adjudicator(Game& game, const TournamentSettings& settings) :
+		_game(game),
+		_settings(settings) {}
+
+void Tournament::_Adjudicator::MoveMade(const Board& premove, const Move& move, bool fromHuman) {
+	_plies++;
+	_moves.push_back(move);
+
+	const Board& board = _game.GetBoard();
+	Piece::Color player = _game.GetPlayerColor();
+
+	if (TablebaseResult result; _settings.tablebase &&
+			_settings.tablebase->Probe(board, player, _game.GetMoveData(), result)) {
+
+		switch (result.outcome) {
+			case TablebaseResult::Outcome::DRAW:
+				_game.Adjudicate(Game::Result::DRAW);
+				break;
+			case TablebaseResult::Outcome::WIN:
+				_game.Adjudicate(player == Piece::Color::WHITE ? Game::Result::WHITE_WINS : Game::Result::BLACK_WINS);
+				break;
+			case TablebaseResult::Outcome::LOSS:
+				_game.Adjudicate(player == Piece::Color::WHITE ? Game::Result::BLACK_WINS : Game::Result::WHITE_WINS);
+				break;
+		}
+
+		return;
+	}
+
+	// the fifty move rule counts plies
+	if ((_settings.max_plies > 0 && _plies >= _settings.max_plies) || _game.GetFiftyMoveRuleCount() >= 100) {
+		_game.Adjudicate(Game::Result::DRAW);
+		return;
+	}
+
+	if (_settings.win_plies > 0) {
+		int score = Evaluator(board).Evaluate(Piece::Color::WHITE);
+
+		_white_streak = score >= _settings.win_score ? _white_streak + 1 : 0;
+		_black_streak = score <= -_settings.win_score ? _black_streak + 1 : 0;
+
+		if (_white_streak >= _settings.win_plies) {
+			_game.Adjudicate(Game::Result::WHITE_WINS);
+		} else if (_black_streak >= _settings.win_plies) {
+			_game.Adjudicate(Game::Result::BLACK_WINS);
+		}
+	}
+}
+
+const std::vector<Move>& Tournament::_Adjudicator::GetMoves() const {
+	return _moves;
+}
+
+Tournament::Tournament(const TournamentSettings& settings, PlayerFactory first, PlayerFactory second) :
+		_settings(settings),
+		_first(std::move(first)),
+		_second(std::move(second)) {}
+
+TournamentScore Tournament::Run(std::ostream& out) {
+	_score = TournamentScore();
+	_decided.store(false);
+
+	if (!_settings.record_file.empty() && !_record_writer.Open(_settings.record_file, true)) {
+		out << "Could not open " << _settings.record_file << std::endl;
+	}
+
+	// the pool is destroyed before returning, which waits for all games.
+	{
+		ThreadPool pool(std::max<size_t>(_settings.concurrency, 1));
+
+		for (size_t i = 0; i < _settings.games; i++) {
+			pool.Submit([this, i, &out]() {
+				if (_decided.load()) {
+					return;
+				}
+
+				bool firstIsWhite = i % 2 == 0;
+				GameRecord record;
+
+				_PlayGame(i, firstIsWhite, record);
+				_AddResult(i, firstIsWhite, record, out);
+			});
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_record_writer.Close();
+	return _score;
+}
+
+void Tournament::_PlayGame(size_t index, bool firstIsWhite, GameRecord& record) const {
+	Game game;
+
+	if (!_settings.openings.empty() && !game.SetState(_settings.openings[(index / 2) % _settings.openings.size()])) {
+		return;
+	}
+
+	record.start_psfen = game.GetPsFEN();
+	record.white = firstIsWhite ? _settings.first_name : _settings.second_name;
+	record.black = firstIsWhite ? _settings.second_name : _settings.first_name;
+
+	game.SetStatisticsSink(nullptr);
+	game.SetTimeControl(_settings.time_control);
+
+	if (firstIsWhite) {
+		game.SetPlayers(_first(Piece::Color::WHITE), _second(Piece::Color::BLACK));
+	} else {
+		game.SetPlayers(_second(Piece::Color::WHITE), _first(Piece::Color::BLACK));
+	}
+
+	_Adjudicator adjudicator(game, _settings);
+	game.Play(&adjudicator);
+
+	record.result = game.GetResult();
+	record.moves = adjudicator.GetMoves();
+	record.final_hash = Zobrist::Hash(game.GetBoard(), game.GetPlayerColor(), game.GetMoveData());
+}
+
+void Tournament::_AddResult(size_t index, bool firstIsWhite, const GameRecord& record, std::ostream& out) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (_record_writer.IsOpen() && record.result != Game::Result::NONE) {
+		_record_writer.Write(record);
+	}
+
+	const char *text = "*";
+
+	switch (record.result) {
+		case Game::Result::NONE:
+			out << "Game " << (index + 1) << ": no result" << std::endl;
+			return;
+		case Game::Result::DRAW:
+			_score.draws++;
+			text = "1/2-1/2";
+			break;
+		case Game::Result::WHITE_WINS:
+			(firstIsWhite ? _score.wins : _score.losses)++;
+			text = "1-0";
+			break;
+		case Game::Result::BLACK_WINS:
+			(firstIsWhite ? _score.losses : _score.wins)++;
+			text = "0-1";
+			break;
+	}
+
+	double llr = _score.GetLogLikelihoodRatio(_settings.elo0, _settings.elo1);
+	double lower = std::log(_settings.beta / (1.0 - _settings.alpha));
+	double upper = std::log((1.0 - _settings.beta) / _settings.alpha);
+
+	out << "Game " << (index + 1) << " (" << (firstIsWhite ? "first" : "second") << " as white): " << text
+			<< "  +" << _score.wins << " -" << _score.losses << " =" << _score.draws
+			<< "  Elo " << _score.GetEloDifference() << " +/- " << _score.GetEloError()
+			<< "  LLR " << llr << " [" << lower << ", " << upper << "]" << std::endl;
+
+	if (!_decided && (llr <= lower || llr >= upper)) {
+		_decided.store(true);
+		out << "SPRT: " << (llr >= upper ? "H1" : "H0") << " accepted" << std::endl;
+	}
+}
+
+}
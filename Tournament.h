@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef TOURNAMENT_H_
+#define TOURNAMENT_H_
+
+#include "Clock.h"
+#include "Game.h"
+#include "GameListener.h"
+#include "GameRecord.h"
+#include "Player.h"
+#include "Tablebase.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ps {
+
+struct TournamentSettings {
+	size_t games = 100;
+
+	// the number of games that are played at the same time.
+	size_t concurrency = std::thread::hardware_concurrency();
+
+	// the PsFENs of the start positions. Every opening is played twice, once
+	// with each player as white. Without openings, all games start from the
+	// default setup.
+	std::vector<std::string> openings;
+
+	TimeControl time_control;
+
+	// a game is adjudicated as a draw after max_plies plies, and as a win when
+	// the static evaluation favours one player by at least win_score for
+	// win_plies plies in a row. Zero disables the rule.
+	int max_plies = 400;
+	int win_score = 1500;
+	int win_plies = 8;
+
+	// games that reach a position in the tables are adjudicated exactly.
+	const Tablebase *tablebase = nullptr;
+
+	// the sequential probability ratio test of H0: elo = elo0 against H1:
+	// elo = elo1. The tournament stops early when either is accepted.
+	double elo0 = 0.0;
+	double elo1 = 10.0;
+	double alpha = 0.05;
+	double beta = 0.05;
+
+	// the games are written to the record file if it is set, with the names
+	// of the players.
+	std::string record_file;
+	std::string first_name = "first";
+	std::string second_name = "second";
+};
+
+/**
+ * The results from the perspective of the first player.
+ */
+struct TournamentScore {
+	size_t wins = 0;
+	size_t losses = 0;
+	size_t draws = 0;
+
+	size_t GetGames() const;
+	double GetScore() const;
+
+	double GetEloDifference() const;
+
+	/**
+	 * Returns the half width of the 95% confidence interval of the Elo
+	 * difference.
+	 */
+	double GetEloError() const;
+
+	/**
+	 * Returns the log-likelihood ratio of elo1 against elo0, using the normal
+	 * approximation of the game results.
+	 */
+	double GetLogLikelihoodRatio(double elo0, double elo1) const;
+};
+
+/**
+ * Plays games between two players on a fixed thread pool, without a user
+ * interface. Every game runs on a single pool thread from start to end.
+ */
+class Tournament {
+
+public:
+	using PlayerFactory = std::function<Player *(Piece::Color color)>;
+
+public:
+	Tournament(const TournamentSettings& settings, PlayerFactory first, PlayerFactory second);
+
+	/**
+	 * Plays the games and writes the progress to the output stream. Returns
+	 * the final score.
+	 */
+	TournamentScore Run(std::ostream& out);
+
+private:
+	class _Adjudicator : public GameListener {
+
+	public:
+		_Adjudicator(Game& game, const TournamentSettings& settings);
+
+		void MoveMade(const Board& premove, const Move& move, bool fromHuman) override;
+		void Mate() override {}
+		void Stalemate() override {}
+		void OutOfTime() override {}
+		void Repetition() override {}
+
+		const std::vector<Move>& GetMoves() const;
+
+	private:
+		Game& _game;
+		const TournamentSettings& _settings;
+
+		int _plies = 0;
+		int _white_streak = 0;
+		int _black_streak = 0;
+
+		std::vector<Move> _moves;
+
+	};
+
+	void _PlayGame(size_t index, bool firstIsWhite, GameRecord& record) const;
+	void _AddResult(size_t index, bool firstIsWhite, const GameRecord& record, std::ostream& out);
+
+	TournamentSettings _settings;
+	PlayerFactory _first;
+	PlayerFactory _second;
+
+	std::mutex _mutex;
+	TournamentScore _score;
+	std::atomic_bool _decided { false };
+	GameRecordWriter _record_writer;
+
+};
+
+}
+
+#endif
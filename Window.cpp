@@ -15,14 +15,16 @@
 
 #include "PlayerHuman.h"
 #include "AiRandom.h"
+#include "AiMcts.h"
 
 #define wxDefault wxDefaultPosition, wxDefaultSize
 
 namespace ps {
 
-const wxString NewGameDialog::_PLAYER_CHOICES[2] = {
+const wxString NewGameDialog::_PLAYER_CHOICES[3] = {
 		"Human",
-		"AI: Random"
+		"AI: Random",
+		"AI: MCTS"
 };
 
 const wxSound soundMove("Resources/wav/Move.wav");
@@ -185,7 +187,7 @@ void BoardView::MouseLeftDownEvent(wxMouseEvent& evt) {
 	// we are not currently holding a piece, so check if the user clicked a
 	// square with a piece. Only pick up a piece if we have a game, and are not
 	// showing an animation
-	if (_animation_queue.empty() && _game && !_display_only && _mouse_point.m_x > 0 && _mouse_point.m_x < 8) {
+	if (_animation_queue.empty() && _game && !_display_only && !_showing_position && _mouse_point.m_x > 0 && _mouse_point.m_x < 8) {
 		// get the x, y position on the board
 		int x = _Col(int(_mouse_point.m_x));
 		int y = _Row(int(_mouse_point.m_y));
@@ -256,6 +258,29 @@ void BoardView::SetLastMove(const ps::Move& move) {
 	_last_move = move;
 }
 
+void BoardView::ShowPosition(const Board& board) {
+	_showing_position = true;
+	_animation_queue = {};
+
+	_moving_piece = Piece();
+	_moving_piece_origin = { -1, -1 };
+	_possible_moves.clear();
+	_is_dragging = false;
+
+	_display = board;
+	Redraw();
+}
+
+void BoardView::ShowGame() {
+	if (!_showing_position) {
+		return;
+	}
+
+	_showing_position = false;
+	ResetDisplay();
+	Redraw();
+}
+
 void BoardView::AddAnimation(const Board& premove, const ps::Move& move) {
 	_animation_queue.emplace(premove, move);
 }
@@ -734,14 +759,14 @@ Player *NewGameDialog::_CreatePlayer(wxComboBox *comboBox, Piece::Color color) {
 	switch (comboBox->GetCurrentSelection()) {
 		case 0: return new PlayerHuman(color, _parent);
 		case 1: return new AiRandom(color);
+		case 2: return new AiMcts(color);
 	}
 
 	return nullptr;
 }
 
 Window::Window() :
-		wxFrame(nullptr, wxID_ANY, L"Paco Ŝako"),
-		_move(new std::promise<ps::Move>()) {
+		wxFrame(nullptr, wxID_ANY, L"Paco Ŝako") {
 
 	SetIcon(wxICON(aaaa));
 
@@ -788,7 +813,6 @@ Window::~Window() {
 	}
 
 	delete _game;
-	delete _move;
 }
 
 void Window::NewGame() {
@@ -804,26 +828,55 @@ void Window::StartGame(Game game, Player *white, Player *black) {
 	_game = new Game(std::move(game));
 	_board_view->SetGame(_game);
 	_board_view->SetPlayerColor(Piece::Color::EMPTY);
+	_board_view->ShowGame();
+
+	_review = *_game;
+
+	for (wxToggleButton *button : _move_buttons) {
+		button->Destroy();
+	}
+
+	_move_buttons.clear();
+	_move_list->FitInside();
 
 	_game->SetPlayers(white, black);
 	_game->StartThread(this);
 }
 
-std::future<ps::Move> Window::StartMove(Piece::Color playerColor) {
-	delete _move;
-	_move = new std::promise<ps::Move>();
-
+MoveHandoff& Window::StartMove(Piece::Color playerColor) {
+	_move_handoff.Reset();
 	_board_view->SetPlayerColor(playerColor);
-	return _move->get_future();
+	return _move_handoff;
+}
+
+void Window::InterruptMove() {
+	_move_handoff.Interrupt();
 }
 
 void Window::FinishMove(const Board& premove, const ps::Move& move, bool fromHuman) {
+	// a new move returns the view to the game
+	_review.GoTo(_review.GetPlyCount());
+	_review.MakeMove(move);
+	_board_view->ShowGame();
+
 	_board_view->SetLastMove(move);
 
 	std::stringstream ss;
 	ss << move;
 
 	wxToggleButton *moveControl = new wxToggleButton(_move_list, wxID_ANY, ss.str().c_str());
+	int ply = _review.GetPly();
+
+	moveControl->Bind(wxEVT_TOGGLEBUTTON, [this, ply](wxCommandEvent& evt) {
+		_GoToPly(ply);
+	});
+
+	for (wxToggleButton *button : _move_buttons) {
+		button->SetValue(false);
+	}
+
+	moveControl->SetValue(true);
+	_move_buttons.push_back(moveControl);
 
 	_move_list_sizer->Add(moveControl, wxSizerFlags().Expand());
 	_move_list->FitInside();
@@ -842,6 +895,12 @@ void Window::FinishMove(const Board& premove, const ps::Move& move, bool fromHum
 	}
 }
 
+void Window::MoveMade(const Board& premove, const ps::Move& move, bool fromHuman) {
+	GetEventHandler()->CallAfter([this, premove, move, fromHuman]() {
+		FinishMove(premove, move, fromHuman);
+	});
+}
+
 void Window::Mate() {
 	soundMate.Play();
 }
@@ -850,11 +909,43 @@ void Window::Stalemate() {
 
 }
 
+void Window::OutOfTime() {
+	soundMate.Play();
+
+	// the turn of a human may have ended without their move
+	GetEventHandler()->CallAfter([this]() {
+		_board_view->SetPlayerColor(Piece::Color::EMPTY);
+	});
+}
+
+void Window::Repetition() {
+
+}
+
 void Window::_MakeMove(const ps::Move& move) {
-	_move->set_value(move);
+	_move_handoff.Deliver(move);
 	_board_view->SetPlayerColor(Piece::Color::EMPTY);
 }
 
+void Window::_GoToPly(int ply) {
+	if (!_review.GoTo(ply)) {
+		return;
+	}
+
+	for (size_t i = 0; i < _move_buttons.size(); i++) {
+		_move_buttons[i]->SetValue(int(i) + 1 == ply);
+	}
+
+	_board_view->SetLastMove(ply > 0 ? _review.GetMove(ply - 1) : ps::Move());
+
+	// the last ply is the position of the game, where moves can be made
+	if (ply == _review.GetPlyCount()) {
+		_board_view->ShowGame();
+	} else {
+		_board_view->ShowPosition(_review.GetBoard());
+	}
+}
+
 void Window::_AnimationThreadMain(Window *window) {
 	while (!window->_animation_stop) {
 		window->GetEventHandler()->CallAfter([window]() {
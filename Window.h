@@ -6,15 +6,17 @@
 
 #include <wx/wx.h>
 #include <wx/scrolwin.h>
+#include <wx/tglbtn.h>
 
 #include <memory>
 #include <unordered_map>
 #include <vector>
-#include <future>
 #include <queue>
 
 #include "Player.h"
 #include "Game.h"
+#include "GameListener.h"
+#include "MoveHandoff.h"
 
 namespace ps {
 
@@ -70,6 +72,13 @@ public:
 	void SetLastMove(const ps::Move& move);
 	void AddAnimation(const Board& premove, const ps::Move& move);
 
+	/**
+	 * Shows the board instead of the position of the game, until ShowGame()
+	 * is called. No pieces can be moved in the meantime.
+	 */
+	void ShowPosition(const Board& board);
+	void ShowGame();
+
 private:
     int _Row(int r) const;
     int _Col(int c) const;
@@ -84,6 +93,7 @@ private:
 
 	Board _display;
 	bool _display_only;
+	bool _showing_position = false;
 	bool _rotated = false;
 	int _tile_size = _MINIMUM_TILE_SIZE;
 
@@ -151,12 +161,12 @@ private:
 private:
 	static constexpr auto _DEFAULT_SETUP = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 	static constexpr auto _EMPTY_SETUP = "8/8/8/8/8/8/8/8 w - - 0 1";
-	static constexpr int _PLAYER_CHOICES_COUNT = 2;
+	static constexpr int _PLAYER_CHOICES_COUNT = 3;
 	const static wxString _PLAYER_CHOICES[_PLAYER_CHOICES_COUNT];
 
 };
 
-class Window : public wxFrame {
+class Window : public wxFrame, public GameListener {
 	friend class BoardView;
 
 public:
@@ -173,14 +183,24 @@ public:
 	void NewGame(wxCommandEvent& evt);
 	void StartGame(Game game, Player *white, Player *black);
 
-	std::future<ps::Move> StartMove(Piece::Color playerColor);
+	/**
+	 * Lets the user make a move for the player. The move is delivered through
+	 * the returned handoff, which the game thread waits on.
+	 */
+	MoveHandoff& StartMove(Piece::Color playerColor);
+	void InterruptMove();
+
 	void FinishMove(const Board& premove, const ps::Move& move, bool fromHuman);
 
-	void Mate();
-	void Stalemate();
+	void MoveMade(const Board& premove, const ps::Move& move, bool fromHuman) override;
+	void Mate() override;
+	void Stalemate() override;
+	void OutOfTime() override;
+	void Repetition() override;
 
 private:
 	void _MakeMove(const ps::Move& move);
+	void _GoToPly(int ply);
 
 	wxMenuBar *_menu;
 	wxMenu *_menu_game;
@@ -188,9 +208,14 @@ private:
 	wxGridSizer *_move_list_sizer;
 	BoardView *_board_view;
 
-	std::promise<ps::Move> *_move;
+	MoveHandoff _move_handoff;
 	Game *_game = nullptr;
 
+	// a copy of the game that is navigated with the move buttons, owned by the
+	// user interface thread.
+	Game _review;
+	std::vector<wxToggleButton *> _move_buttons;
+
 	std::unique_ptr<std::thread> _animation_thread;
 	std::atomic_bool _animation_stop;
 
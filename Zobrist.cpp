@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#include "Zobrist.h"
+
+#include <array>
+
+namespace ps {
+
+struct ZobristKeys {
+	// indexed by square, side and Piece::Type
+	std::array<std::array<std::array<uint64_t, 7>, 2>, 64> pieces;
+	uint64_t black_to_move;
+	std::array<uint64_t, 4> castling;
+	std::array<uint64_t, 8> en_passant;
+
+	ZobristKeys() {
+		// splitmix64, from a fixed seed
+		uint64_t state = 0x5041434f53414b4f;
+		const auto next = [&state]() {
+			uint64_t z = (state += 0x9e3779b97f4a7c15);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+			return z ^ (z >> 31);
+		};
+
+		for (auto& square : pieces) {
+			for (auto& side : square) {
+				side[0] = 0;
+
+				for (size_t type = 1; type < side.size(); type++) {
+					side[type] = next();
+				}
+			}
+		}
+
+		black_to_move = next();
+
+		for (auto& key : castling) {
+			key = next();
+		}
+
+		for (auto& key : en_passant) {
+			key = next();
+		}
+	}
+};
+
+static const ZobristKeys keys;
+
+uint64_t Zobrist::Hash(const Board& board, Piece::Color player, const GameMoveData& moveData) {
+	uint64_t hash = HashPlayer(player) ^ HashMoveData(moveData);
+
+	for (int r = 0; r < 8; r++) {
+		for (int c = 0; c < 8; c++) {
+			hash ^= HashPiece({ r, c }, board[{ r, c }]);
+		}
+	}
+
+	return hash;
+}
+
+uint64_t Zobrist::HashPiece(const BoardPosition& position, const Piece& piece) {
+	const auto& square = keys.pieces[position.GetRow() * 8 + position.GetColumn()];
+	return square[0][size_t(piece.GetWhiteType())] ^ square[1][size_t(piece.GetBlackType())];
+}
+
+uint64_t Zobrist::HashPlayer(Piece::Color player) {
+	return player == Piece::Color::BLACK ? keys.black_to_move : 0;
+}
+
+uint64_t Zobrist::HashMoveData(const GameMoveData& moveData) {
+	uint64_t hash = 0;
+
+	if (moveData.can_white_castle_king_side) hash ^= keys.castling[0];
+	if (moveData.can_white_castle_queen_side) hash ^= keys.castling[1];
+	if (moveData.can_black_castle_king_side) hash ^= keys.castling[2];
+	if (moveData.can_black_castle_queen_side) hash ^= keys.castling[3];
+
+	if (moveData.en_passant_position.IsValid()) {
+		hash ^= keys.en_passant[moveData.en_passant_position.GetColumn()];
+	}
+
+	return hash;
+}
+
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2020 Levi van Rheenen. All rights reserved.
+ */
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include "Board.h"
+#include "GameMoveData.h"
+
+#include <cstdint>
+
+namespace ps {
+
+/**
+ * Zobrist hashing of positions. The keys are generated from a fixed seed, so
+ * hashes are stable between runs and can be stored in files.
+ */
+class Zobrist {
+
+public:
+	static uint64_t Hash(const Board& board, Piece::Color player, const GameMoveData& moveData);
+
+	/**
+	 * The key of a piece on a square. A union is the combination of the keys
+	 * of both halves.
+	 */
+	static uint64_t HashPiece(const BoardPosition& position, const Piece& piece);
+
+	/**
+	 * The key of the side to move, the castling rights and the en passant
+	 * position.
+	 */
+	static uint64_t HashPlayer(Piece::Color player);
+	static uint64_t HashMoveData(const GameMoveData& moveData);
+
+};
+
+}
+
+#endif